@@ -0,0 +1,304 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_bcast.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free single-writer/multi-reader broadcast ring.
+ * @note    Every reader keeps its own cursor over a single copy of the items
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "emblib32_bcast.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Broadcast
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static uint8_t* _bcast_slot(const t_bcast* ctrl, size_t pos);
+static size_t _bcast_limit(const t_bcast* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t bcast_init(t_bcast* ctrl, void* buff, size_t buff_size, size_t item_size, t_bcast_reader* readers, size_t reader_count, uint16_t mode)
+{
+  /* Sanity check */
+  if (!ctrl || !buff || (item_size == 0) || (buff_size < 2) || ((buff_size & (buff_size - 1)) != 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!readers || (reader_count == 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((mode != BCAST_OPMODE_BLOCK) && (mode != BCAST_OPMODE_OVERWRITE))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize ring */
+  ctrl->buff         = (uint8_t*)buff;
+  ctrl->buff_size    = buff_size;
+  ctrl->item_size    = item_size;
+  ctrl->mask         = buff_size - 1;
+  ctrl->mode         = mode;
+  ctrl->readers      = readers;
+  ctrl->reader_count = reader_count;
+  ctrl->tail         = 0;
+
+  /* Every reader starts up to date */
+  for (size_t idx = 0; idx < reader_count; idx++)
+  {
+    readers[idx].cursor   = 0;
+    readers[idx].overruns = 0;
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t bcast_push(t_bcast* ctrl, const void* item)
+{
+  size_t tail;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  tail = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  if (ctrl->mode & BCAST_OPMODE_BLOCK)
+  {
+    /* The slot is free once every reader moved past it */
+    for (size_t idx = 0; idx < ctrl->reader_count; idx++)
+    {
+      if ((tail - ATOMIC_LOAD_ACQUIRE(&ctrl->readers[idx].cursor)) >= ctrl->buff_size)
+      {
+        return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+      }
+    }
+  }
+  else
+  {
+    /* Readers must see the previous tail before the slot starts changing */
+    ATOMIC_FENCE_RELEASE();
+  }
+
+  /* Fill the slot and hand it over to the readers */
+  memcpy(_bcast_slot(ctrl, tail), item, ctrl->item_size);
+  ATOMIC_STORE_RELEASE(&ctrl->tail, (tail + 1));
+  return EMBLIB32_OK;
+}
+
+uint32_t bcast_pop(t_bcast* ctrl, size_t reader, void* item)
+{
+  t_bcast_reader* state;
+  size_t          limit;
+  size_t          tail;
+  size_t          pos;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item || (reader >= ctrl->reader_count))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  state = &ctrl->readers[reader];
+  limit = _bcast_limit(ctrl);
+  pos   = state->cursor;
+  for (;;)
+  {
+    tail = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+    if (tail == pos)
+    {
+      memset(item, 0x00, ctrl->item_size);
+      return EMBLIB32_ERROR_BUFFER_EMPTY;
+    }
+
+    /* Skip the items the writer already overwrote */
+    if ((tail - pos) > limit)
+    {
+      state->overruns += (uint32_t)(tail - pos - limit);
+      pos              = tail - limit;
+    }
+
+    /* Read the slot. On overwrite mode it is only valid if the writer didn't reach it meanwhile */
+    memcpy(item, _bcast_slot(ctrl, pos), ctrl->item_size);
+    if (!(ctrl->mode & BCAST_OPMODE_OVERWRITE))
+    {
+      break;
+    }
+    ATOMIC_FENCE_ACQUIRE();
+    if ((ATOMIC_LOAD_RELAXED(&ctrl->tail) - pos) <= limit)
+    {
+      break;
+    }
+  }
+
+  /* Free the slot (BLOCK mode writer) */
+  ATOMIC_STORE_RELEASE(&state->cursor, (pos + 1));
+  return EMBLIB32_OK;
+}
+
+uint32_t bcast_sync(t_bcast* ctrl, size_t reader)
+{
+  /* Sanity check */
+  if (!ctrl || (reader >= ctrl->reader_count))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  ATOMIC_STORE_RELEASE(&ctrl->readers[reader].cursor, ATOMIC_LOAD_ACQUIRE(&ctrl->tail));
+  return EMBLIB32_OK;
+}
+
+bool bcast_is_empty(const t_bcast* ctrl, size_t reader)
+{
+  /* Sanity check */
+  if (!ctrl || (reader >= ctrl->reader_count))
+  {
+    return false;
+  }
+
+  return bcast_get_count(ctrl, reader) == 0;
+}
+
+size_t bcast_get_size(const t_bcast* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  return ctrl->buff_size;
+}
+
+size_t bcast_get_count(const t_bcast* ctrl, size_t reader)
+{
+  size_t cursor;
+  size_t tail;
+
+  /* Sanity check */
+  if (!ctrl || (reader >= ctrl->reader_count))
+  {
+    return 0;
+  }
+
+  cursor = ATOMIC_LOAD_ACQUIRE(&ctrl->readers[reader].cursor);
+  tail   = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+  return MIN((tail - cursor), _bcast_limit(ctrl));
+}
+
+uint32_t bcast_get_overruns(const t_bcast* ctrl, size_t reader)
+{
+  /* Sanity check */
+  if (!ctrl || (reader >= ctrl->reader_count))
+  {
+    return 0;
+  }
+
+  return ctrl->readers[reader].overruns;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Gets the slot for a given position
+ * @param ctrl Broadcast ring controller
+ * @param pos  Position (free running)
+ * @return Slot address
+ */
+static uint8_t* _bcast_slot(const t_bcast* ctrl, size_t pos)
+{
+  return ctrl->buff + ((pos & ctrl->mask) * ctrl->item_size);
+}
+
+/**
+ * @brief Gets the maximum number of items a reader may hold
+ * @note  On overwrite mode the slot the writer fills next is excluded
+ * @param ctrl Broadcast ring controller
+ * @return Maximum backlog (# items)
+ */
+static size_t _bcast_limit(const t_bcast* ctrl)
+{
+  return (ctrl->mode & BCAST_OPMODE_OVERWRITE)? (ctrl->buff_size - 1) : ctrl->buff_size;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Broadcast -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_bcast.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free single-writer/multi-reader broadcast ring.
+ * @note    Every reader keeps its own cursor over a single copy of the items
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_BCAST_H_
+#define _EMBLIB32_BCAST_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Broadcast
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Broadcast ring operation modes */
+typedef enum
+{
+  BCAST_OPMODE_BLOCK      = 0x01,    /*!< BLOCK:  The writer is rejected until the slowest reader frees a slot */
+  BCAST_OPMODE_OVERWRITE  = 0x02,    /*!< OVW:    The writer never waits, lagging readers lose the oldest items */
+} t_bcast_mode;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Broadcast reader state (one per reader, owned by the reader context) */
+typedef struct
+{
+  volatile size_t cursor BUFF_CACHE_ALIGNED;  /*!< Next read position (free running) */
+  uint32_t        overruns;   /*!< Items lost because the writer overwrote them */
+} t_bcast_reader;
+
+/** Broadcast ring controller structure */
+typedef struct
+{
+  uint8_t*        buff;       /*!< Array of items */
+  size_t          buff_size;  /*!< Ring size (# items, power of two) */
+  size_t          item_size;  /*!< Item size (bytes) */
+  size_t          mask;       /*!< Index mask (buff_size - 1) */
+  uint32_t        mode;       /*!< Ring operation mode */
+  t_bcast_reader* readers;    /*!< Array of readers */
+  size_t          reader_count; /*!< Number of readers */
+  /* Writer state */
+  volatile size_t tail BUFF_CACHE_ALIGNED;  /*!< Next write position (free running) */
+} t_bcast;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a broadcast ring instance
+ * @note  This function is thread unsafe. Use with care
+ *        On BCAST_OPMODE_OVERWRITE a reader holds up to buff_size - 1 items: the slot next to be written is
+ *        never handed out, so a reader can't get an item while it is being overwritten
+ * @param ctrl          Broadcast ring controller
+ * @param buff          Array of items
+ * @param buff_size     Ring size (# items, power of two)
+ * @param item_size     Item size (bytes)
+ * @param readers       Array of readers
+ * @param reader_count  Number of readers
+ * @param mode          Operation mode (see t_bcast_mode)
+ * @return Error code
+ */
+uint32_t bcast_init(t_bcast* ctrl, void* buff, size_t buff_size, size_t item_size, t_bcast_reader* readers, size_t reader_count, uint16_t mode);
+
+/**
+ * @brief Pushes an item to every reader
+ * @note  Lock-free. Only one context may push
+ * @param ctrl      Broadcast ring controller
+ * @param item      Incoming item
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if the slowest reader didn't free a slot, BLOCK mode)
+ */
+uint32_t bcast_push(t_bcast* ctrl, const void* item);
+
+/**
+ * @brief Pops the oldest item of a reader
+ * @note  Lock-free. Only one context may pop for a given reader. Lost items are added to the reader overruns
+ * @param ctrl      Broadcast ring controller
+ * @param reader    Reader index
+ * @param item      Receiving item
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if the reader is up to date)
+ */
+uint32_t bcast_pop(t_bcast* ctrl, size_t reader, void* item);
+
+/**
+ * @brief Drops the pending items of a reader (jumps to the newest position)
+ * @note  Must be called from the reader context
+ * @param ctrl      Broadcast ring controller
+ * @param reader    Reader index
+ * @return Error code
+ */
+uint32_t bcast_sync(t_bcast* ctrl, size_t reader);
+
+/**
+ * @brief Returns if a reader has no pending items
+ * @param ctrl      Broadcast ring controller
+ * @param reader    Reader index
+ * @return True if the reader is up to date
+ */
+bool bcast_is_empty(const t_bcast* ctrl, size_t reader);
+
+/**
+ * @brief Get the broadcast ring size
+ * @param ctrl      Broadcast ring controller
+ * @return Ring size (# items)
+ */
+size_t bcast_get_size(const t_bcast* ctrl);
+
+/**
+ * @brief Get the number of items pending for a reader
+ * @param ctrl      Broadcast ring controller
+ * @param reader    Reader index
+ * @return Items pending (# items)
+ */
+size_t bcast_get_count(const t_bcast* ctrl, size_t reader);
+
+/**
+ * @brief Get the number of items a reader lost (BCAST_OPMODE_OVERWRITE)
+ * @param ctrl      Broadcast ring controller
+ * @param reader    Reader index
+ * @return Items lost (# items)
+ */
+uint32_t bcast_get_overruns(const t_bcast* ctrl, size_t reader);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Broadcast -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_BCAST_H_ */
@@ -0,0 +1,531 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_bipbuff.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Variable-length record buffer (bip-buffer).
+ * @note    Records are always stored contiguously, prefixed by their length
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <string.h>
+
+#include "emblib32_bipbuff.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup BipBuffer
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void _bipbuff_lock(const t_bipbuff* ctrl, bool lock);
+static bool _bipbuff_find(const t_bipbuff* ctrl, size_t total, size_t* pos);
+static size_t _bipbuff_front(const t_bipbuff* ctrl);
+static void _bipbuff_release(t_bipbuff* ctrl, size_t size);
+static void _bipbuff_normalize(t_bipbuff* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t bipbuff_init(t_bipbuff* ctrl, void* buff, size_t buff_size)
+{
+  /* Sanity check */
+  if (!ctrl || !buff || (buff_size <= BIPBUFF_HEADER_SIZE))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize bip-buffer */
+  ctrl->buff         = (uint8_t*)buff;
+  ctrl->buff_size    = buff_size;
+  ctrl->a_start      = 0;
+  ctrl->a_end        = 0;
+  ctrl->b_end        = 0;
+  ctrl->b_active     = false;
+  ctrl->reserve_pos  = 0;
+  ctrl->reserve_size = 0;
+  ctrl->count        = 0;
+  ctrl->lock         = NULL;
+  ctrl->object       = NULL;
+  return EMBLIB32_OK;
+}
+
+uint32_t bipbuff_set_lock(t_bipbuff* ctrl, t_rtos_lock lock, void* object)
+{
+  /* Validate */
+  if (!ctrl || !lock)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  /* Update */
+  ctrl->lock   = lock;
+  ctrl->object = object;
+  return EMBLIB32_OK;
+}
+
+uint32_t bipbuff_clear(t_bipbuff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _bipbuff_lock(ctrl, true);
+
+  /* Process */
+  memset(ctrl->buff, 0, ctrl->buff_size);
+  ctrl->a_start      = 0;
+  ctrl->a_end        = 0;
+  ctrl->b_end        = 0;
+  ctrl->b_active     = false;
+  ctrl->reserve_size = 0;
+  ctrl->count        = 0;
+
+  _bipbuff_lock(ctrl, false);
+
+  return EMBLIB32_OK;
+}
+
+uint32_t bipbuff_reserve(t_bipbuff* ctrl, size_t size, void** record)
+{
+  uint32_t status = EMBLIB32_OK;
+  size_t   pos;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !record || (size == 0) || (size > BIPBUFF_RECORD_MAX))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _bipbuff_lock(ctrl, true);
+
+  /* Drop the pending reservation (if any) */
+  ctrl->reserve_size = 0;
+  _bipbuff_normalize(ctrl);
+
+  /* Find a contiguous region for the header and the data */
+  if (_bipbuff_find(ctrl, BIPBUFF_RECORD_SIZE(size), &pos))
+  {
+    ctrl->reserve_pos  = pos;
+    ctrl->reserve_size = size;
+    *record = ctrl->buff + pos + BIPBUFF_HEADER_SIZE;
+  }
+  else
+  {
+    *record = NULL;
+    status  = EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+
+  _bipbuff_lock(ctrl, false);
+
+  return status;
+}
+
+uint32_t bipbuff_commit(t_bipbuff* ctrl, size_t size)
+{
+  uint16_t header;
+  size_t   pos;
+  size_t   total;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _bipbuff_lock(ctrl, true);
+
+  /* Validate the pending reservation */
+  if ((ctrl->reserve_size == 0) || (size > ctrl->reserve_size))
+  {
+    _bipbuff_lock(ctrl, false);
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Publish the record */
+  pos   = ctrl->reserve_pos;
+  total = BIPBUFF_RECORD_SIZE(size);
+  ctrl->reserve_size = 0;
+  if (size != 0)
+  {
+    header = (uint16_t)size;
+    memcpy((ctrl->buff + pos), &header, BIPBUFF_HEADER_SIZE);
+    if (ctrl->b_active && (pos == ctrl->b_end))
+    {
+      ctrl->b_end += total;
+    }
+    else if (pos == ctrl->a_end)
+    {
+      ctrl->a_end += total;
+    }
+    else
+    {
+      /* Writer wrapped to the start of the array */
+      ctrl->b_end    = total;
+      ctrl->b_active = true;
+    }
+    ctrl->count++;
+  }
+  _bipbuff_normalize(ctrl);
+
+  _bipbuff_lock(ctrl, false);
+
+  return EMBLIB32_OK;
+}
+
+uint32_t bipbuff_push(t_bipbuff* ctrl, const void* data, size_t size)
+{
+  uint32_t status;
+  void*    record;
+
+  /* Sanity check */
+  if (!data)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Process */
+  status = bipbuff_reserve(ctrl, size, &record);
+  if (status != EMBLIB32_OK)
+  {
+    return status;
+  }
+  memcpy(record, data, size);
+  return bipbuff_commit(ctrl, size);
+}
+
+uint32_t bipbuff_peek(t_bipbuff* ctrl, void** record, size_t* size)
+{
+  uint32_t status = EMBLIB32_OK;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !record || !size)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _bipbuff_lock(ctrl, true);
+
+  /* Process */
+  if (ctrl->count == 0)
+  {
+    *record = NULL;
+    *size   = 0;
+    status  = EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+  else
+  {
+    *record = ctrl->buff + ctrl->a_start + BIPBUFF_HEADER_SIZE;
+    *size   = _bipbuff_front(ctrl);
+  }
+
+  _bipbuff_lock(ctrl, false);
+
+  return status;
+}
+
+uint32_t bipbuff_consume(t_bipbuff* ctrl)
+{
+  uint32_t status = EMBLIB32_OK;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _bipbuff_lock(ctrl, true);
+
+  /* Process */
+  if (ctrl->count == 0)
+  {
+    status = EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+  else
+  {
+    _bipbuff_release(ctrl, _bipbuff_front(ctrl));
+  }
+
+  _bipbuff_lock(ctrl, false);
+
+  return status;
+}
+
+uint32_t bipbuff_pop(t_bipbuff* ctrl, void* buff, size_t size, size_t* popped)
+{
+  uint32_t status = EMBLIB32_OK;
+  size_t   length;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !buff || !popped)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _bipbuff_lock(ctrl, true);
+
+  /* Process */
+  *popped = 0;
+  if (ctrl->count == 0)
+  {
+    status = EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+  else
+  {
+    length = _bipbuff_front(ctrl);
+    if (length > size)
+    {
+      status = EMBLIB32_ERROR_BUFFER_INDEX;
+    }
+    else
+    {
+      memcpy(buff, (ctrl->buff + ctrl->a_start + BIPBUFF_HEADER_SIZE), length);
+      _bipbuff_release(ctrl, length);
+      *popped = length;
+    }
+  }
+
+  _bipbuff_lock(ctrl, false);
+
+  return status;
+}
+
+bool bipbuff_is_empty(const t_bipbuff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+
+  return ctrl->count == 0;
+}
+
+size_t bipbuff_get_size(const t_bipbuff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  return ctrl->buff_size;
+}
+
+size_t bipbuff_get_count(const t_bipbuff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  return ctrl->count;
+}
+
+size_t bipbuff_get_used(const t_bipbuff* ctrl)
+{
+  size_t used;
+
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  _bipbuff_lock(ctrl, true);
+  used = (ctrl->a_end - ctrl->a_start) + (ctrl->b_active? ctrl->b_end : 0);
+  _bipbuff_lock(ctrl, false);
+
+  return used;
+}
+
+size_t bipbuff_get_available(const t_bipbuff* ctrl)
+{
+  size_t free;
+
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  _bipbuff_lock(ctrl, true);
+  if (ctrl->b_active)
+  {
+    free = ctrl->a_start - ctrl->b_end;
+  }
+  else
+  {
+    free = MAX((ctrl->buff_size - ctrl->a_end), ctrl->a_start);
+  }
+  _bipbuff_lock(ctrl, false);
+
+  return (free > BIPBUFF_HEADER_SIZE)? MIN((free - BIPBUFF_HEADER_SIZE), BIPBUFF_RECORD_MAX) : 0;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Calls the lock handler (if any)
+ * @param ctrl      Bip-buffer controller
+ * @param lock      True to lock, false to unlock
+ */
+static void _bipbuff_lock(const t_bipbuff* ctrl, bool lock)
+{
+  if (ctrl->lock)
+  {
+    ctrl->lock(ctrl->object, lock);
+  }
+}
+
+/**
+ * @brief Finds a contiguous free region
+ * @note  Writes continue after region B if active, otherwise after region A and,
+ *        if there is no room before the end of the array, wrap to the start
+ * @param ctrl      Bip-buffer controller
+ * @param total     Region size (bytes)
+ * @param pos       Returns the region start
+ * @return True if found
+ */
+static bool _bipbuff_find(const t_bipbuff* ctrl, size_t total, size_t* pos)
+{
+  if (ctrl->b_active)
+  {
+    *pos = ctrl->b_end;
+    return (ctrl->a_start - ctrl->b_end) >= total;
+  }
+  if ((ctrl->buff_size - ctrl->a_end) >= total)
+  {
+    *pos = ctrl->a_end;
+    return true;
+  }
+  *pos = 0;
+  return ctrl->a_start >= total;
+}
+
+/**
+ * @brief Gets the length of the oldest record
+ * @param ctrl      Bip-buffer controller
+ * @return Record length (bytes)
+ */
+static size_t _bipbuff_front(const t_bipbuff* ctrl)
+{
+  uint16_t header;
+
+  memcpy(&header, (ctrl->buff + ctrl->a_start), BIPBUFF_HEADER_SIZE);
+  return header;
+}
+
+/**
+ * @brief Releases the oldest record
+ * @param ctrl      Bip-buffer controller
+ * @param size      Record length (bytes)
+ */
+static void _bipbuff_release(t_bipbuff* ctrl, size_t size)
+{
+  ctrl->a_start += BIPBUFF_RECORD_SIZE(size);
+  ctrl->count--;
+  _bipbuff_normalize(ctrl);
+}
+
+/**
+ * @brief Keeps region A as the one holding the oldest records
+ * @note  When region A is drained region B takes its place. If both are empty the regions are
+ *        rewound to the start of the array (unless a reservation is pending after region A)
+ * @param ctrl      Bip-buffer controller
+ */
+static void _bipbuff_normalize(t_bipbuff* ctrl)
+{
+  if (ctrl->a_start != ctrl->a_end)
+  {
+    return;
+  }
+  if (ctrl->b_active)
+  {
+    ctrl->a_start  = 0;
+    ctrl->a_end    = ctrl->b_end;
+    ctrl->b_end    = 0;
+    ctrl->b_active = false;
+  }
+  else if (ctrl->reserve_size == 0)
+  {
+    ctrl->a_start = 0;
+    ctrl->a_end   = 0;
+  }
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: BipBuffer -->
+*//*--------------------------------------------------------------------------*/
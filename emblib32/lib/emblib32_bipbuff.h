@@ -0,0 +1,225 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_bipbuff.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Variable-length record buffer (bip-buffer).
+ * @note    Records are always stored contiguously, prefixed by their length
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_BIPBUFF_H_
+#define _EMBLIB32_BIPBUFF_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+#include "emblib32_rtos.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup BipBuffer
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Record header size (bytes): the record length is stored as an uint16_t */
+#define BIPBUFF_HEADER_SIZE     sizeof(uint16_t)
+
+/** Maximum record length (bytes) */
+#define BIPBUFF_RECORD_MAX      UINT16_MAX
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Storage used by a record of the given length (bytes) */
+#define BIPBUFF_RECORD_SIZE(size)   (BIPBUFF_HEADER_SIZE + (size))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * Bip-buffer controller structure.
+ * Stored records live in up to two regions: A = [a_start, a_end) and, once the writer wrapped, B = [0, b_end).
+ * Records are read from A and written after B (if active) or after A, so a record never crosses the end of the array.
+ */
+typedef struct
+{
+  uint8_t*        buff;         /*!< Array of bytes */
+  size_t          buff_size;    /*!< Buffer size (bytes) */
+  size_t          a_start;      /*!< Region A start (oldest record) */
+  size_t          a_end;        /*!< Region A end */
+  size_t          b_end;        /*!< Region B end (region B starts at zero) */
+  bool            b_active;     /*!< Region B in use */
+  size_t          reserve_pos;  /*!< Pending reservation start (record header) */
+  size_t          reserve_size; /*!< Pending reservation length (bytes, zero if none) */
+  size_t          count;        /*!< Number of records stored */
+  /* RTOS support */
+  t_rtos_lock     lock;         /*!< Lock handler function */
+  void*           object;       /*!< Lock object */
+} t_bipbuff;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a bip-buffer instance
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl      Bip-buffer controller
+ * @param buff      Array of bytes
+ * @param buff_size Buffer size (bytes)
+ * @return Error code
+ */
+uint32_t bipbuff_init(t_bipbuff* ctrl, void* buff, size_t buff_size);
+
+/**
+ * @brief Set a lock function handler for the bip-buffer
+ * @param ctrl      Bip-buffer controller
+ * @param lock      Lock function handler
+ * @param object    Lock object
+ * @return Error code
+ */
+uint32_t bipbuff_set_lock(t_bipbuff* ctrl, t_rtos_lock lock, void* object);
+
+/**
+ * @brief Clears the bip-buffer (drops all the records and any pending reservation)
+ * @param ctrl      Bip-buffer controller
+ * @return Error code
+ */
+uint32_t bipbuff_clear(t_bipbuff* ctrl);
+
+/**
+ * @brief Reserves a contiguous record to be written in place (zero-copy push)
+ * @note  Only one producer may hold a reservation at a time. A new reservation replaces the pending one
+ * @param ctrl      Bip-buffer controller
+ * @param size      Record length (bytes, up to BIPBUFF_RECORD_MAX)
+ * @param record    Returns the start of the record data (byte aligned)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if there is no contiguous space)
+ */
+uint32_t bipbuff_reserve(t_bipbuff* ctrl, size_t size, void** record);
+
+/**
+ * @brief Commits the record obtained with bipbuff_reserve
+ * @param ctrl      Bip-buffer controller
+ * @param size      Final record length (bytes, up to the reserved length). Zero cancels the reservation
+ * @return Error code
+ */
+uint32_t bipbuff_commit(t_bipbuff* ctrl, size_t size);
+
+/**
+ * @brief Pushes a record into the bip-buffer
+ * @param ctrl      Bip-buffer controller
+ * @param data      Record data
+ * @param size      Record length (bytes, up to BIPBUFF_RECORD_MAX)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if there is no contiguous space)
+ */
+uint32_t bipbuff_push(t_bipbuff* ctrl, const void* data, size_t size);
+
+/**
+ * @brief Gets the oldest record without removing it (zero-copy pop)
+ * @note  The record stays valid until it is released with bipbuff_consume
+ * @param ctrl      Bip-buffer controller
+ * @param record    Returns the start of the record data
+ * @param size      Returns the record length (bytes)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if there are no records)
+ */
+uint32_t bipbuff_peek(t_bipbuff* ctrl, void** record, size_t* size);
+
+/**
+ * @brief Releases the oldest record
+ * @param ctrl      Bip-buffer controller
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if there are no records)
+ */
+uint32_t bipbuff_consume(t_bipbuff* ctrl);
+
+/**
+ * @brief Pops the oldest record from the bip-buffer
+ * @note  If the record does not fit on the receiving buffer it is kept and EMBLIB32_ERROR_BUFFER_INDEX is returned
+ * @param ctrl      Bip-buffer controller
+ * @param buff      Receiving buffer
+ * @param size      Receiving buffer size (bytes)
+ * @param popped    Returns the record length (bytes)
+ * @return Error code
+ */
+uint32_t bipbuff_pop(t_bipbuff* ctrl, void* buff, size_t size, size_t* popped);
+
+/**
+ * @brief Returns if the bip-buffer is empty
+ * @param ctrl      Bip-buffer controller
+ * @return True if bip-buffer is empty
+ */
+bool bipbuff_is_empty(const t_bipbuff* ctrl);
+
+/**
+ * @brief Get the bip-buffer total size
+ * @param ctrl      Bip-buffer controller
+ * @return Buffer size (bytes)
+ */
+size_t bipbuff_get_size(const t_bipbuff* ctrl);
+
+/**
+ * @brief Get the number of records stored in the bip-buffer
+ * @param ctrl      Bip-buffer controller
+ * @return Records stored (# records)
+ */
+size_t bipbuff_get_count(const t_bipbuff* ctrl);
+
+/**
+ * @brief Get the storage used by the records (headers included)
+ * @param ctrl      Bip-buffer controller
+ * @return Used storage (bytes)
+ */
+size_t bipbuff_get_used(const t_bipbuff* ctrl);
+
+/**
+ * @brief Get the largest record that can be reserved right now
+ * @param ctrl      Bip-buffer controller
+ * @return Record length (bytes)
+ */
+size_t bipbuff_get_available(const t_bipbuff* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: BipBuffer -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_BIPBUFF_H_ */
@@ -13,10 +13,31 @@
  *
  ******************************************************************************
  */
+#if defined(__linux__)
+  #define _GNU_SOURCE
+#endif
+
 #include <string.h>
 
 #include "emblib32_buffer.h"
 
+#if (BUFF_MIRROR_SUPPORT == 1U) || (BUFF_PERSIST_FILE_SUPPORT == 1U)
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#if BUFF_PERSIST_FILE_SUPPORT == 1U
+  #include <fcntl.h>
+#endif
+
+#if (BUFF_ENABLE_STATS == 1U) && (EMBLIB32_HOST)
+  #include <time.h>
+#endif
+
+#if EMBLIB32_HOST
+  #include <pthread.h>
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @addtogroup EmbLib32
 * @{
@@ -40,6 +61,50 @@
 * @{
 *//*--------------------------------------------------------------------------*/
 
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL
+  /** Disable interrupts, saving the previous state (BUFF_LOCK_CRITICAL) */
+  #ifndef BUFF_CRITICAL_ENTER
+    #if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+      #define BUFF_CRITICAL_ENTER(state)  __asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (state) :: "memory")
+    #elif EMBLIB32_HOST
+      #define BUFF_CRITICAL_ENTER(state)  do { _buff_critical_enter(); (state) = 0U; } while (0)
+    #else
+      #error "BUFF_LOCK_CRITICAL requires BUFF_CRITICAL_ENTER/BUFF_CRITICAL_EXIT on this target"
+    #endif
+  #endif
+  /** Restore the interrupts state (BUFF_LOCK_CRITICAL) */
+  #ifndef BUFF_CRITICAL_EXIT
+    #if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+      #define BUFF_CRITICAL_EXIT(state)   __asm volatile ("msr primask, %0" :: "r" (state) : "memory")
+    #elif EMBLIB32_HOST
+      #define BUFF_CRITICAL_EXIT(state)   do { (void)(state); _buff_critical_exit(); } while (0)
+    #endif
+  #endif
+#endif
+
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_MUTEX
+  /** Take the mutex given as lock object (BUFF_LOCK_MUTEX) */
+  #ifndef BUFF_MUTEX_LOCK
+    #if EMBLIB32_HOST
+      #define BUFF_MUTEX_LOCK(object)     pthread_mutex_lock((pthread_mutex_t*)(object))
+      #define BUFF_MUTEX_UNLOCK(object)   pthread_mutex_unlock((pthread_mutex_t*)(object))
+    #else
+      #error "BUFF_LOCK_MUTEX requires BUFF_MUTEX_LOCK/BUFF_MUTEX_UNLOCK on this target"
+    #endif
+  #endif
+#endif
+
+#if BUFF_TXN_SUPPORT == 1U
+  /** Current context identifier (transaction owner, non-zero) */
+  #ifndef BUFF_CONTEXT_ID
+    #if EMBLIB32_HOST
+      #define BUFF_CONTEXT_ID()           ((uintptr_t)pthread_self())
+    #else
+      #define BUFF_CONTEXT_ID()           ((uintptr_t)1U)
+    #endif
+  #endif
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PRIVATE_TUNABLES -->
 *//*-----------------------------------------------------------------------*//**
@@ -47,6 +112,9 @@
 * @{
 *//*--------------------------------------------------------------------------*/
 
+/** Persistent store signature ("BUFF") */
+#define BUFF_PERSIST_MAGIC          0x46465542U
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PRIVATE_Definitions -->
 *//*-----------------------------------------------------------------------*//**
@@ -54,6 +122,16 @@
 * @{
 *//*--------------------------------------------------------------------------*/
 
+#if BUFF_ENABLE_STATS == 1U
+  /** Add to a statistics counter */
+  #define BUFF_STATS_ADD(ctrl, field, count)  ((ctrl)->stats.field += (uint32_t)(count))
+  /** Track the peak occupancy */
+  #define BUFF_STATS_PEAK(ctrl, head, tail)   _buff_stats_peak((ctrl), (head), (tail))
+#else
+  #define BUFF_STATS_ADD(ctrl, field, count)  ((void)0)
+  #define BUFF_STATS_PEAK(ctrl, head, tail)   ((void)0)
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PRIVATE_Macros -->
 *//*-----------------------------------------------------------------------*//**
@@ -68,6 +146,11 @@
 * @{
 *//*--------------------------------------------------------------------------*/
 
+#if (BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL) && (EMBLIB32_HOST)
+/** Critical section emulation (HOST) */
+static volatile uint32_t _buff_critical = 0U;
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PRIVATE_Data -->
 *//*-----------------------------------------------------------------------*//**
@@ -77,6 +160,43 @@
 
 static uint32_t _buff_push_backend(t_buff* ctrl, const void* item);
 static uint32_t _buff_pop_backend(t_buff* ctrl, void* item);
+static uint32_t _buff_spsc_push_backend(t_buff* ctrl, const void* item);
+static uint32_t _buff_spsc_pop_backend(t_buff* ctrl, void* item);
+static size_t _buff_push_chunk_backend(t_buff* ctrl, const uint8_t* buff, size_t size);
+static size_t _buff_pop_chunk_backend(t_buff* ctrl, uint8_t* buff, size_t size);
+static uint32_t _buff_push_iov_backend(t_buff* ctrl, const t_buff_span* iov, size_t iov_count, size_t total);
+static size_t _buff_pop_iov_backend(t_buff* ctrl, const t_buff_span* iov, size_t iov_count);
+static bool _buff_iov_size(const t_buff_span* iov, size_t iov_count, size_t* total);
+static void _buff_heap_push(t_buff* ctrl, const void* item);
+static void _buff_heap_pop(t_buff* ctrl, void* item);
+static void _buff_write(t_buff* ctrl, size_t index, const uint8_t* buff, size_t count);
+static void _buff_read(const t_buff* ctrl, size_t index, uint8_t* buff, size_t count);
+
+static size_t _buff_advance(const t_buff* ctrl, size_t index, size_t count);
+static size_t _buff_retreat(const t_buff* ctrl, size_t index, size_t count);
+static size_t _buff_position(const t_buff* ctrl, size_t index);
+static size_t _buff_offset(const t_buff* ctrl, size_t index);
+static size_t _buff_contiguous(const t_buff* ctrl, size_t index);
+static size_t _buff_stored(const t_buff* ctrl, size_t head, size_t tail);
+
+static void _buff_pushed(t_buff* ctrl);
+static void _buff_popped(t_buff* ctrl);
+static void _buff_notify(const t_buff* ctrl, volatile size_t* waiters, void* event);
+static bool _buff_waiter_take(volatile size_t* waiters);
+static uint32_t _buff_persist_checksum(const t_buff_persist* store);
+#if BUFF_TXN_SUPPORT == 1U
+static inline bool _buff_txn_held(const t_buff* ctrl);
+#endif
+static inline void _buff_acquire(t_buff* ctrl);
+static inline void _buff_release(t_buff* ctrl);
+#if (BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL) && (EMBLIB32_HOST)
+static void _buff_critical_enter(void);
+static void _buff_critical_exit(void);
+#endif
+#if BUFF_ENABLE_STATS == 1U
+static void _buff_stats_peak(t_buff* ctrl, size_t head, size_t tail);
+#endif
+static inline void _buff_copy(const t_buff* ctrl, void* dst, const void* src);
 
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PRIVATE_Functions -->
@@ -92,341 +212,2083 @@ uint32_t buff_init(t_buff* ctrl, void* buff, size_t buff_size, size_t item_size,
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
+  if ((mode & BUFF_OPMODE_SPSC) && (!(mode & BUFF_OPMODE_R_FIFO) || (mode & (BUFF_OPMODE_R_LIFO | BUFF_OPMODE_W_OVERFLOW))))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((mode & BUFF_OPMODE_R_PRIORITY) && (mode & (BUFF_OPMODE_R_FIFO | BUFF_OPMODE_R_LIFO | BUFF_OPMODE_W_OVERFLOW | BUFF_OPMODE_SPSC)))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((mode & BUFF_OPMODE_DMA) && (!(mode & BUFF_OPMODE_R_FIFO) || (mode & (BUFF_OPMODE_R_LIFO | BUFF_OPMODE_W_OVERFLOW | BUFF_OPMODE_SPSC))))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
 
   /* Initialize buff */
-  ctrl->buff      = (uint8_t*)buff;
-  ctrl->buff_size = buff_size;
-  ctrl->item_size = item_size;
-  ctrl->capacity  = (buff_size * item_size);
-  ctrl->mode      = mode;
-  ctrl->lock      = NULL;
-  ctrl->object    = NULL;
-
-  /* Clear buffer if required */
+  ctrl->buff        = (uint8_t*)buff;
+  ctrl->buff_size   = buff_size;
+  ctrl->item_size   = item_size;
+  ctrl->capacity    = (buff_size * item_size);
+  ctrl->mask        = ((buff_size & (buff_size - 1)) == 0)? ((buff_size << 1) - 1) : 0;
+  ctrl->mirrored    = false;
+  ctrl->mode        = mode;
+  ctrl->lock        = NULL;
+  ctrl->object      = NULL;
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_SPINLOCK
+  ctrl->spin        = 0U;
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL
+  ctrl->irq_state   = 0U;
+#endif
+#if BUFF_TXN_SUPPORT == 1U
+  ctrl->txn_owner   = 0U;
+  ctrl->txn_depth   = 0U;
+#endif
+  ctrl->wait        = NULL;
+  ctrl->notify      = NULL;
+  ctrl->data_event  = NULL;
+  ctrl->space_event = NULL;
+  ctrl->data_waiters  = 0;
+  ctrl->space_waiters = 0;
+  ctrl->compare     = NULL;
+  ctrl->on_high     = NULL;
+  ctrl->on_low      = NULL;
+  ctrl->wm_object   = NULL;
+  ctrl->wm_high     = 0;
+  ctrl->wm_low      = 0;
+  ctrl->wm_above    = false;
+#if BUFF_ENABLE_STATS == 1U
+  memset(&ctrl->stats, 0, sizeof(ctrl->stats));
+#endif
+
+  /* Clear buffer if required (on DMA mode the transfer starts at the first item) */
   if (clear)
   {
+    ctrl->tail = 0;
     buff_clear(ctrl);
   }
   return EMBLIB32_OK;
 }
 
-uint32_t buff_set_lock(t_buff* ctrl, t_rtos_lock lock, void* object)
+uint32_t buff_init_persistent(t_buff_persist* store, size_t buff_size, size_t item_size, uint16_t mode, bool* recovered)
 {
-  /* Validate */
-  if (!ctrl || !lock)
+  t_buff* ctrl;
+  bool    valid;
+
+  /* Sanity check */
+  if (!store || (item_size == 0) || (buff_size == 0) || (mode & BUFF_OPMODE_R_PRIORITY))
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  /* Update */
-  ctrl->lock   = lock;
-  ctrl->object = object;
+  if ((buff_size > (UINT32_MAX >> 1)) || ((size_t)(uint32_t)item_size != item_size))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Check the header left by the previous run */
+  valid = (store->magic == BUFF_PERSIST_MAGIC) && (store->checksum == _buff_persist_checksum(store)) &&
+          (store->layout == sizeof(t_buff)) && (store->buff_size == buff_size) &&
+          (store->item_size == item_size) && (store->mode == mode);
+
+  /* Rebuild the controller. Head and tail are kept, the items array is not touched */
+  ctrl = &store->buff;
+  if (buff_init(ctrl, (uint8_t*)(store + 1), buff_size, item_size, mode, false) != EMBLIB32_OK)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  valid = valid && (ctrl->head < (buff_size << 1)) && (ctrl->tail < (buff_size << 1)) &&
+          (_buff_stored(ctrl, ctrl->head, ctrl->tail) <= buff_size);
+  if (valid)
+  {
+    store->generation++;
+  }
+  else
+  {
+    ctrl->head        = 0;
+    ctrl->tail        = 0;
+    store->generation = 0;
+  }
+
+  /* Seal the header */
+  store->magic     = BUFF_PERSIST_MAGIC;
+  store->layout    = (uint32_t)sizeof(t_buff);
+  store->buff_size = (uint32_t)buff_size;
+  store->item_size = (uint32_t)item_size;
+  store->mode      = mode;
+  store->checksum  = _buff_persist_checksum(store);
+  if (recovered)
+  {
+    *recovered = valid;
+  }
   return EMBLIB32_OK;
 }
 
-uint32_t buff_lock(t_buff* ctrl, bool lock)
+#if BUFF_PERSIST_FILE_SUPPORT == 1U
+uint32_t buff_persist_map(t_buff_persist** store, const char* path, size_t buff_size, size_t item_size)
 {
+  size_t bytes;
+  void*  base;
+  int    fd;
+
   /* Sanity check */
-  if (!ctrl)
+  if (!store || !path || (item_size == 0) || (buff_size == 0))
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  /* Lock */
-  if (ctrl->lock)
+
+  /* Map the file (its previous contents are kept) */
+  bytes = BUFF_PERSIST_SIZE(buff_size, item_size);
+  fd    = open(path, (O_RDWR | O_CREAT | O_CLOEXEC), 0600);
+  if (fd < 0)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  base = MAP_FAILED;
+  if (ftruncate(fd, (off_t)bytes) == 0)
+  {
+    base = mmap(NULL, bytes, (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED)
   {
-    ctrl->lock(ctrl->object, lock);
+    return EMBLIB32_ERROR_PARAMETER;
   }
+  *store = (t_buff_persist*)base;
   return EMBLIB32_OK;
 }
 
-uint32_t buff_clear(t_buff* ctrl)
+uint32_t buff_persist_unmap(t_buff_persist* store)
 {
   /* Sanity check */
-  if (!ctrl || !ctrl->buff)
+  if (!store || (store->magic != BUFF_PERSIST_MAGIC))
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  buff_lock(ctrl, true);
 
-  /* Process */
-  memset(ctrl->buff, 0, ctrl->capacity);
-  ctrl->stored = 0;
-  ctrl->head   = 0;
-  ctrl->tail   = 0;
-  
-  buff_lock(ctrl, false);
-  
+  munmap(store, BUFF_PERSIST_SIZE(store->buff_size, store->item_size));
   return EMBLIB32_OK;
 }
+#endif /* BUFF_PERSIST_FILE_SUPPORT */
 
-uint32_t buff_push(t_buff* ctrl, const void* item)
+#if BUFF_MIRROR_SUPPORT == 1U
+uint32_t buff_init_mirrored(t_buff* ctrl, size_t buff_size, size_t item_size, uint16_t mode)
 {
-  uint32_t status;
+  size_t   page;
+  size_t   step;
+  size_t   bytes;
+  uint8_t* base;
+  int      fd;
 
   /* Sanity check */
-  if (!ctrl || !ctrl->buff || !item)
+  if (!ctrl || (item_size == 0) || (buff_size == 0))
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  buff_lock(ctrl, true);
-  
-  /* Handle push */
-  status = _buff_push_backend(ctrl, item);
-  
-  buff_lock(ctrl, false);
-  
-  return status;
-}
 
-uint32_t buff_push_chunk(t_buff* ctrl, const void* buff, size_t size, size_t* pushed)
-{
-  uint32_t      status = EMBLIB32_OK;
-  size_t        count  = 0;
-  const uint8_t *head  = (const uint8_t*)buff;
+  /* Round the size up to a whole number of pages */
+  page = (size_t)sysconf(_SC_PAGESIZE);
+  step = page;
+  while ((step % item_size) != 0)
+  {
+    step += page;
+  }
+  step     /= item_size;
+  buff_size = ((buff_size + step - 1) / step) * step;
+  bytes     = buff_size * item_size;
 
-  /* Sanity check */
-  if (!ctrl || !ctrl->buff || !buff)
+  /* Map the same memory twice, back-to-back */
+  fd = memfd_create("emblib32_buff", MFD_CLOEXEC);
+  if (fd < 0)
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  buff_lock(ctrl, true);
-
-  /* Handle push */
-  while (count < size)
+  base = (uint8_t*)MAP_FAILED;
+  if (ftruncate(fd, (off_t)bytes) == 0)
   {
-    status = _buff_push_backend(ctrl, (head + (count * ctrl->item_size)));
-    if (status != EMBLIB32_OK)
-    {
-      break;
-    }
-    count++;
+    base = (uint8_t*)mmap(NULL, (bytes << 1), PROT_NONE, (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+  }
+  if ((base != MAP_FAILED) &&
+      ((mmap(base, bytes, (PROT_READ | PROT_WRITE), (MAP_SHARED | MAP_FIXED), fd, 0) == MAP_FAILED) ||
+       (mmap((base + bytes), bytes, (PROT_READ | PROT_WRITE), (MAP_SHARED | MAP_FIXED), fd, 0) == MAP_FAILED)))
+  {
+    munmap(base, (bytes << 1));
+    base = (uint8_t*)MAP_FAILED;
+  }
+  close(fd);
+  if (base == MAP_FAILED)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  buff_lock(ctrl, false);
 
-  /* Update pushed count */
-  if (pushed)
+  /* Initialize buff (fresh pages are already zeroed) */
+  if (buff_init(ctrl, base, buff_size, item_size, mode, false) != EMBLIB32_OK)
   {
-    *pushed = count;
+    munmap(base, (bytes << 1));
+    return EMBLIB32_ERROR_PARAMETER;
   }
-  return status;
+  ctrl->head     = 0;
+  ctrl->tail     = 0;
+  ctrl->mirrored = true;
+  return EMBLIB32_OK;
 }
 
-uint32_t buff_pop(t_buff* ctrl, void* item)
+uint32_t buff_deinit_mirrored(t_buff* ctrl)
 {
-  uint32_t status;
-
   /* Sanity check */
-  if (!ctrl || !ctrl->buff)
+  if (!ctrl || !ctrl->buff || !ctrl->mirrored)
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  buff_lock(ctrl, true);
 
-  /* Handle pop */
-  status = _buff_pop_backend(ctrl, item);
-  
-  buff_lock(ctrl, false);
-  
-  return status;
+  munmap(ctrl->buff, (ctrl->capacity << 1));
+  ctrl->buff     = NULL;
+  ctrl->mirrored = false;
+  return EMBLIB32_OK;
 }
+#endif /* BUFF_MIRROR_SUPPORT */
 
-uint32_t buff_pop_chunk(t_buff* ctrl, void* buff, size_t size, size_t* popped)
+uint32_t buff_set_lock(t_buff* ctrl, t_rtos_lock lock, void* object)
 {
-  uint32_t  status = EMBLIB32_OK;
-  size_t    count  = 0;
-  uint8_t   *head  = (uint8_t*)buff;
+  /* Validate */
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_CALLBACK
+  if (!ctrl || !lock)
+#else
+  if (!ctrl)
+#endif
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  /* Update */
+  ctrl->lock   = lock;
+  ctrl->object = object;
+  return EMBLIB32_OK;
+}
 
+uint32_t buff_lock(t_buff* ctrl, bool lock)
+{
   /* Sanity check */
-  if (!ctrl || !ctrl->buff || !buff)
+  if (!ctrl)
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  buff_lock(ctrl, true);
-
-  /* Handle pop */
-  while (count < size)
+  /* Lock */
+  if (lock)
   {
-    status = _buff_pop_backend(ctrl, (head + (count * ctrl->item_size)));
-    if (status != EMBLIB32_OK)
-    {
-      break;
-    }
-    count++;
+    _buff_acquire(ctrl);
   }
-  
-  buff_lock(ctrl, false);
-
-  /* Update popped count */
-  if (popped)
+  else
   {
-    *popped = count;
+    _buff_release(ctrl);
   }
-  return (count == 0)? EMBLIB32_ERROR_BUFFER_EMPTY : EMBLIB32_OK;
+  return EMBLIB32_OK;
 }
 
-uint32_t buff_peek(t_buff* ctrl, void* item, size_t index)
+#if BUFF_TXN_SUPPORT == 1U
+uint32_t buff_begin(t_buff* ctrl)
 {
-  size_t offset;
-  
+  uintptr_t context;
+
   /* Sanity check */
-  if (!ctrl || !ctrl->buff)
+  if (!ctrl || (ctrl->mode & BUFF_OPMODE_SPSC))
   {
     return EMBLIB32_ERROR_PARAMETER;
   }
-  if ((index >= ctrl->buff_size) || (index >= buff_get_count(ctrl)))
+
+  /* Nested transaction */
+  context = BUFF_CONTEXT_ID();
+  if (ATOMIC_LOAD_RELAXED(&ctrl->txn_owner) == context)
   {
-    return EMBLIB32_ERROR_BUFFER_INDEX;
+    ctrl->txn_depth++;
+    return EMBLIB32_OK;
   }
-  
-  buff_lock(ctrl, true);
 
-  /* Read item */
-  if (ctrl->mode & BUFF_OPMODE_R_FIFO)
+  /* Hold the lock until buff_end */
+  _buff_acquire(ctrl);
+  ctrl->txn_depth = 1U;
+  ATOMIC_STORE_RELEASE(&ctrl->txn_owner, context);
+  return EMBLIB32_OK;
+}
+
+uint32_t buff_end(t_buff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl || (ATOMIC_LOAD_RELAXED(&ctrl->txn_owner) != BUFF_CONTEXT_ID()))
   {
-    offset = (ctrl->head + (index * ctrl->item_size)) % ctrl->capacity;
+    return EMBLIB32_ERROR_PARAMETER;
   }
-  else
+
+  /* Release the lock on the outermost call (the owner must be cleared first) */
+  if (--ctrl->txn_depth == 0U)
   {
-    offset = (ctrl->capacity + ctrl->tail - ((index + 1) * ctrl->item_size)) % ctrl->capacity;
+    ATOMIC_STORE_RELEASE(&ctrl->txn_owner, (uintptr_t)0U);
+    _buff_release(ctrl);
   }
-  memcpy(item, (ctrl->buff + offset), ctrl->item_size);
-  
-  buff_lock(ctrl, false);
-  
   return EMBLIB32_OK;
 }
+#endif /* BUFF_TXN_SUPPORT */
 
-bool buff_is_full(const t_buff* ctrl)
+uint32_t buff_set_notify(t_buff* ctrl, t_rtos_wait wait, t_rtos_notify notify, void* data_event, void* space_event)
 {
-  /* Sanity check */
-  if (!ctrl)
+  /* Validate */
+  if (!ctrl || !wait || !notify)
   {
-    return false;
+    return EMBLIB32_ERROR_PARAMETER;
   }
-
-  return ctrl->stored == ctrl->capacity;
+  /* Update */
+  ctrl->wait        = wait;
+  ctrl->notify      = notify;
+  ctrl->data_event  = data_event;
+  ctrl->space_event = space_event;
+  return EMBLIB32_OK;
 }
 
-bool buff_is_empty(const t_buff* ctrl)
+uint32_t buff_wait_begin(t_buff* ctrl, uint32_t events)
 {
   /* Sanity check */
-  if (!ctrl)
+  if (!ctrl || (events == 0) || (events & ~(uint32_t)(BUFF_WAIT_DATA | BUFF_WAIT_SPACE)))
   {
-    return false;
+    return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  return ctrl->stored == 0;
+
+  if (events & BUFF_WAIT_DATA)
+  {
+    ATOMIC_FETCH_ADD_RELAXED(&ctrl->data_waiters, 1U);
+  }
+  if (events & BUFF_WAIT_SPACE)
+  {
+    ATOMIC_FETCH_ADD_RELAXED(&ctrl->space_waiters, 1U);
+  }
+  /* Pairs with _buff_notify: either the caller sees the new state or the notifier sees the registration */
+  ATOMIC_FENCE_SEQ_CST();
+  return EMBLIB32_OK;
 }
 
-size_t buff_get_size(const t_buff* ctrl)
+size_t buff_wait_end(t_buff* ctrl, uint32_t events)
 {
+  size_t pending = 0;
+
   /* Sanity check */
   if (!ctrl)
   {
-    return false;
+    return 0;
   }
-  
-  return ctrl->buff_size;
+
+  if ((events & BUFF_WAIT_DATA) && !_buff_waiter_take(&ctrl->data_waiters))
+  {
+    pending++;
+  }
+  if ((events & BUFF_WAIT_SPACE) && !_buff_waiter_take(&ctrl->space_waiters))
+  {
+    pending++;
+  }
+  return pending;
 }
 
-size_t buff_get_count(const t_buff* ctrl)
+uint32_t buff_set_priority(t_buff* ctrl, t_buff_compare compare)
 {
-  /* Sanity check */
-  if (!ctrl)
+  /* Validate */
+  if (!ctrl || !compare || !(ctrl->mode & BUFF_OPMODE_R_PRIORITY))
   {
-    return false;
+    return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  return ctrl->stored / ctrl->item_size;
+  /* Update */
+  ctrl->compare = compare;
+  return EMBLIB32_OK;
 }
 
-size_t buff_get_available(const t_buff* ctrl)
+uint32_t buff_set_watermarks(t_buff* ctrl, size_t high, size_t low, t_buff_watermark on_high, t_buff_watermark on_low, void* object)
 {
-  /* Sanity check */
-  if (!ctrl)
+  /* Validate */
+  if (!ctrl || (!on_high && !on_low) || (high == 0) || (high > ctrl->buff_size) || (low >= high))
   {
-    return false;
+    return EMBLIB32_ERROR_PARAMETER;
   }
-  
-  return (ctrl->capacity - ctrl->stored) / ctrl->item_size;
+  /* Update (disarm while reconfiguring) */
+  ctrl->wm_high   = 0;
+  ctrl->on_high   = on_high;
+  ctrl->on_low    = on_low;
+  ctrl->wm_object = object;
+  ctrl->wm_low    = low;
+  ctrl->wm_above  = (buff_get_count(ctrl) >= high);
+  ATOMIC_STORE_RELEASE(&ctrl->wm_high, high);
+  return EMBLIB32_OK;
 }
 
-/*-------------------------------------------------------------------------*//**
-* @} <!-- End: PUBLIC_API -->
-*//*-----------------------------------------------------------------------*//**
-* @addtogroup PRIVATE_Functions
-* @{
-*//*--------------------------------------------------------------------------*/
-
-/**
- * @brief Pushes an item into the buffer
- * @note  This function is the backend for the public API. It is not intended to be called directly.
- *        This function is NOT performing any sanity check.
- * @param ctrl Buffer controller
- * @param item Incoming item
- * @return Error code
- */
-static uint32_t _buff_push_backend(t_buff* ctrl, const void* item)
+uint32_t buff_flush(t_buff* ctrl)
 {
-  /* Handle overflow */
-  if (!(ctrl->mode & BUFF_OPMODE_W_OVERFLOW) && buff_is_full(ctrl))
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
   {
-    return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+    return EMBLIB32_ERROR_PARAMETER;
   }
 
-  /* Handle push */
-  memcpy((ctrl->buff + ctrl->tail), item, ctrl->item_size);
-  ctrl->tail = (ctrl->tail + ctrl->item_size) % ctrl->capacity;
-
-  /* Handle storage and read offset */
-  if (ctrl->stored == ctrl->capacity)
+  /* Hand the pending items over even if the high watermark was not reached */
+  count = buff_get_count(ctrl);
+  if (count == 0)
   {
-    ctrl->head = ctrl->tail;
+    return EMBLIB32_ERROR_BUFFER_EMPTY;
   }
-  else
+  if (ctrl->on_high)
   {
-    ctrl->stored += ctrl->item_size;
+    ctrl->on_high(ctrl->wm_object, count);
   }
   return EMBLIB32_OK;
 }
 
-/**
- * @brief Pops an item from the buffer
- * @note  This function is the backend for the public API. It is not intended to be called directly.
- *        This function is NOT performing any sanity check.
- * @param ctrl Buffer controller
- * @param item  Receiving item
- * @return Error code
- */
-static uint32_t _buff_pop_backend(t_buff* ctrl, void* item)
+uint32_t buff_clear(t_buff* ctrl)
 {
-  /* Handle empty */
-  if (buff_is_empty(ctrl))
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
   {
-    memset(item, 0x00, ctrl->item_size);
-    return EMBLIB32_ERROR_BUFFER_EMPTY;
+    return EMBLIB32_ERROR_PARAMETER;
   }
+  
+  _buff_acquire(ctrl);
 
-  /* Handle read */
-  if (ctrl->mode & BUFF_OPMODE_R_FIFO)
+  /* Process (the DMA keeps writing at its own position: only the pending items are dropped) */
+  if (ctrl->mode & BUFF_OPMODE_DMA)
   {
-    memcpy(item, (ctrl->buff + ctrl->head), ctrl->item_size);
-    ctrl->head = (ctrl->head + ctrl->item_size) % ctrl->capacity;
+    ctrl->head = ctrl->tail;
   }
   else
   {
-    ctrl->tail = (ctrl->capacity + ctrl->tail - ctrl->item_size) % ctrl->capacity;
-    memcpy(item, (ctrl->buff + ctrl->tail), ctrl->item_size);
+    memset(ctrl->buff, 0, ctrl->capacity);
+    ctrl->head = 0;
+    ctrl->tail = 0;
   }
-  ctrl->stored -= ctrl->item_size;
+  
+  _buff_release(ctrl);
+  
+  _buff_popped(ctrl);
   return EMBLIB32_OK;
 }
 
+uint32_t buff_push(t_buff* ctrl, const void* item)
+{
+  uint32_t status;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item || ((ctrl->mode & BUFF_OPMODE_R_PRIORITY) && !ctrl->compare))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (ctrl->mode & BUFF_OPMODE_DMA)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  
+  /* Handle push */
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    status = _buff_spsc_push_backend(ctrl, item);
+  }
+  else
+  {
+    _buff_acquire(ctrl);
+    status = _buff_push_backend(ctrl, item);
+    _buff_release(ctrl);
+  }
+
+  /* Wake up the consumers */
+  if (status == EMBLIB32_OK)
+  {
+    _buff_pushed(ctrl);
+  }
+  return status;
+}
+
+uint32_t buff_push_wait(t_buff* ctrl, const void* item, uint32_t timeout)
+{
+  uint32_t status;
+  uint32_t start;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->wait || !ctrl->space_event)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Retry each time a consumer frees space, until the deadline (a notification consumes the registration) */
+  start = rtos_get_time();
+  do
+  {
+    buff_wait_begin(ctrl, BUFF_WAIT_SPACE);
+    status = buff_push(ctrl, item);
+  } while ((status == EMBLIB32_ERROR_BUFFER_OVERFLOW) && ctrl->wait(ctrl->space_event, rtos_get_remaining(start, timeout)));
+
+  /* Drop the registration, or consume the notification sent for it meanwhile */
+  if (buff_wait_end(ctrl, BUFF_WAIT_SPACE) != 0)
+  {
+    ctrl->wait(ctrl->space_event, RTOS_WAIT_FOREVER);
+  }
+  return status;
+}
+
+uint32_t buff_push_chunk(t_buff* ctrl, const void* buff, size_t size, size_t* pushed)
+{
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !buff || ((ctrl->mode & BUFF_OPMODE_R_PRIORITY) && !ctrl->compare))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (ctrl->mode & BUFF_OPMODE_DMA)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    count = _buff_push_chunk_backend(ctrl, (const uint8_t*)buff, size);
+  }
+  else
+  {
+    _buff_acquire(ctrl);
+    count = _buff_push_chunk_backend(ctrl, (const uint8_t*)buff, size);
+    _buff_release(ctrl);
+  }
+
+  /* Update pushed count */
+  if (pushed)
+  {
+    *pushed = count;
+  }
+  if (count != 0)
+  {
+    _buff_pushed(ctrl);
+  }
+  return (count < size)? EMBLIB32_ERROR_BUFFER_OVERFLOW : EMBLIB32_OK;
+}
+
+uint32_t buff_push_iov(t_buff* ctrl, const t_buff_span* iov, size_t iov_count)
+{
+  uint32_t status;
+  size_t   total;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !iov || ((ctrl->mode & BUFF_OPMODE_R_PRIORITY) && !ctrl->compare))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (ctrl->mode & BUFF_OPMODE_DMA)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!_buff_iov_size(iov, iov_count, &total))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    status = _buff_push_iov_backend(ctrl, iov, iov_count, total);
+  }
+  else
+  {
+    _buff_acquire(ctrl);
+    status = _buff_push_iov_backend(ctrl, iov, iov_count, total);
+    _buff_release(ctrl);
+  }
+
+  if ((status == EMBLIB32_OK) && (total != 0))
+  {
+    _buff_pushed(ctrl);
+  }
+  return status;
+}
+
+uint32_t buff_reserve(t_buff* ctrl, void** buff, size_t* size)
+{
+  size_t tail;
+  size_t head;
+  size_t space;
+  size_t contiguous;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !buff || !size || !(ctrl->mode & BUFF_OPMODE_R_FIFO))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (ctrl->mode & BUFF_OPMODE_DMA)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Get the free region up to the wrap point */
+  tail       = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  head       = ATOMIC_LOAD_ACQUIRE(&ctrl->head);
+  space      = ctrl->buff_size - _buff_stored(ctrl, head, tail);
+  contiguous = MIN(*size, _buff_contiguous(ctrl, tail));
+  if ((ctrl->mode & BUFF_OPMODE_W_OVERFLOW) && (contiguous > space))
+  {
+    /* Drop the oldest items */
+    BUFF_STATS_ADD(ctrl, dropped, (contiguous - space));
+    ctrl->head = _buff_advance(ctrl, head, (contiguous - space));
+    space      = contiguous;
+  }
+  *size = MIN(contiguous, space);
+  *buff = ctrl->buff + _buff_offset(ctrl, tail);
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  return (*size == 0)? EMBLIB32_ERROR_BUFFER_OVERFLOW : EMBLIB32_OK;
+}
+
+uint32_t buff_commit(t_buff* ctrl, size_t size)
+{
+  uint32_t status = EMBLIB32_OK;
+  size_t   tail;
+  size_t   head;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !(ctrl->mode & BUFF_OPMODE_R_FIFO))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (ctrl->mode & BUFF_OPMODE_DMA)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Publish the written items */
+  tail = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  head = ATOMIC_LOAD_ACQUIRE(&ctrl->head);
+  if ((size > (ctrl->buff_size - _buff_stored(ctrl, head, tail))) || (size > _buff_contiguous(ctrl, tail)))
+  {
+    status = EMBLIB32_ERROR_PARAMETER;
+  }
+  else
+  {
+    tail = _buff_advance(ctrl, tail, size);
+    ATOMIC_STORE_RELEASE(&ctrl->tail, tail);
+    BUFF_STATS_ADD(ctrl, pushed, size);
+    BUFF_STATS_PEAK(ctrl, head, tail);
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  if ((status == EMBLIB32_OK) && (size != 0))
+  {
+    _buff_pushed(ctrl);
+  }
+  return status;
+}
+
+uint32_t buff_pop(t_buff* ctrl, void* item)
+{
+  uint32_t status;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  
+  /* Handle pop */
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    status = _buff_spsc_pop_backend(ctrl, item);
+  }
+  else
+  {
+    _buff_acquire(ctrl);
+    status = _buff_pop_backend(ctrl, item);
+    _buff_release(ctrl);
+  }
+
+  /* Wake up the producers */
+  if (status == EMBLIB32_OK)
+  {
+    _buff_popped(ctrl);
+  }
+  return status;
+}
+
+uint32_t buff_pop_wait(t_buff* ctrl, void* item, uint32_t timeout)
+{
+  uint32_t status;
+  uint32_t start;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->wait || !ctrl->data_event)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Retry each time a producer adds data, until the deadline (a notification consumes the registration) */
+  start = rtos_get_time();
+  do
+  {
+    buff_wait_begin(ctrl, BUFF_WAIT_DATA);
+    status = buff_pop(ctrl, item);
+  } while ((status == EMBLIB32_ERROR_BUFFER_EMPTY) && ctrl->wait(ctrl->data_event, rtos_get_remaining(start, timeout)));
+
+  /* Drop the registration, or consume the notification sent for it meanwhile */
+  if (buff_wait_end(ctrl, BUFF_WAIT_DATA) != 0)
+  {
+    ctrl->wait(ctrl->data_event, RTOS_WAIT_FOREVER);
+  }
+  return status;
+}
+
+uint32_t buff_pop_chunk(t_buff* ctrl, void* buff, size_t size, size_t* popped)
+{
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    count = _buff_pop_chunk_backend(ctrl, (uint8_t*)buff, size);
+  }
+  else
+  {
+    _buff_acquire(ctrl);
+    count = _buff_pop_chunk_backend(ctrl, (uint8_t*)buff, size);
+    _buff_release(ctrl);
+  }
+
+  /* Update popped count */
+  if (popped)
+  {
+    *popped = count;
+  }
+  if (count != 0)
+  {
+    _buff_popped(ctrl);
+  }
+  return (count == 0)? EMBLIB32_ERROR_BUFFER_EMPTY : EMBLIB32_OK;
+}
+
+uint32_t buff_pop_iov(t_buff* ctrl, const t_buff_span* iov, size_t iov_count, size_t* popped)
+{
+  size_t total;
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !iov)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!_buff_iov_size(iov, iov_count, &total))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    count = _buff_pop_iov_backend(ctrl, iov, iov_count);
+  }
+  else
+  {
+    _buff_acquire(ctrl);
+    count = _buff_pop_iov_backend(ctrl, iov, iov_count);
+    _buff_release(ctrl);
+  }
+
+  /* Update popped count */
+  if (popped)
+  {
+    *popped = count;
+  }
+  if (count != 0)
+  {
+    _buff_popped(ctrl);
+  }
+  return (count == 0)? EMBLIB32_ERROR_BUFFER_EMPTY : EMBLIB32_OK;
+}
+
+uint32_t buff_peek(t_buff* ctrl, void* item, size_t index)
+{
+  size_t offset;
+  
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((index >= ctrl->buff_size) || (index >= buff_get_count(ctrl)))
+  {
+    return EMBLIB32_ERROR_BUFFER_INDEX;
+  }
+  
+  if (ctrl->mode & BUFF_OPMODE_SPSC)
+  {
+    /* Consumer side: the head can't move, the tail only grows */
+    offset = _buff_offset(ctrl, _buff_advance(ctrl, ATOMIC_LOAD_RELAXED(&ctrl->head), index));
+    _buff_copy(ctrl, item, (ctrl->buff + offset));
+    return EMBLIB32_OK;
+  }
+  
+  _buff_acquire(ctrl);
+
+  /* Read item (on PRIORITY mode index zero is the next item, the rest follow the heap order) */
+  if (ctrl->mode & (BUFF_OPMODE_R_FIFO | BUFF_OPMODE_R_PRIORITY))
+  {
+    offset = _buff_offset(ctrl, _buff_advance(ctrl, ctrl->head, index));
+  }
+  else
+  {
+    offset = _buff_offset(ctrl, _buff_retreat(ctrl, ctrl->tail, (index + 1)));
+  }
+  _buff_copy(ctrl, item, (ctrl->buff + offset));
+  
+  _buff_release(ctrl);
+  
+  return EMBLIB32_OK;
+}
+
+uint32_t buff_peek_chunk(t_buff* ctrl, void* buff, size_t start, size_t size, size_t* peeked)
+{
+  uint8_t* dst   = (uint8_t*)buff;
+  size_t   count = 0;
+  size_t   stored;
+  size_t   index;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Read items (FIFO: at most two copies, LIFO: one per item, newest first) */
+  index  = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  stored = _buff_stored(ctrl, index, ATOMIC_LOAD_ACQUIRE(&ctrl->tail));
+  if (start < stored)
+  {
+    count = MIN(size, (stored - start));
+    if (ctrl->mode & BUFF_OPMODE_R_LIFO)
+    {
+      index = _buff_retreat(ctrl, ctrl->tail, start);
+      for (size_t idx = 0; idx < count; idx++)
+      {
+        index = _buff_retreat(ctrl, index, 1);
+        _buff_copy(ctrl, dst, (ctrl->buff + _buff_offset(ctrl, index)));
+        dst  += ctrl->item_size;
+      }
+    }
+    else
+    {
+      _buff_read(ctrl, _buff_advance(ctrl, index, start), dst, count);
+    }
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  /* Report */
+  if (peeked)
+  {
+    *peeked = count;
+  }
+  if (count == 0)
+  {
+    return (stored == 0)? EMBLIB32_ERROR_BUFFER_EMPTY : EMBLIB32_ERROR_BUFFER_INDEX;
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t buff_iter_begin(t_buff* ctrl, t_buff_iter* iter)
+{
+  size_t head;
+  size_t tail;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !iter)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Snapshot the stored items */
+  head          = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  tail          = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+  iter->ctrl    = ctrl;
+  iter->count   = _buff_stored(ctrl, head, tail);
+  iter->reverse = (ctrl->mode & BUFF_OPMODE_R_LIFO)? true : false;
+  iter->index   = iter->reverse? tail : head;
+  return EMBLIB32_OK;
+}
+
+const void* buff_iter_next(t_buff_iter* iter)
+{
+  t_buff* ctrl;
+  size_t  index;
+
+  /* Sanity check */
+  if (!iter || !iter->ctrl || (iter->count == 0))
+  {
+    return NULL;
+  }
+
+  /* Move to the next item */
+  ctrl = iter->ctrl;
+  iter->count--;
+  if (iter->reverse)
+  {
+    iter->index = _buff_retreat(ctrl, iter->index, 1);
+    index       = iter->index;
+  }
+  else
+  {
+    index       = iter->index;
+    iter->index = _buff_advance(ctrl, iter->index, 1);
+  }
+  return ctrl->buff + _buff_offset(ctrl, index);
+}
+
+uint32_t buff_iter_next_span(t_buff_iter* iter, t_buff_span* span)
+{
+  t_buff* ctrl;
+  size_t  count;
+
+  /* Sanity check */
+  if (!iter || !iter->ctrl || !span)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (iter->count == 0)
+  {
+    span->buff = NULL;
+    span->size = 0;
+    return EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+
+  /* Take the items up to the wrap point (LIFO: down to the start of the items array) */
+  ctrl = iter->ctrl;
+  if (iter->reverse)
+  {
+    count       = MIN(iter->count, (_buff_position(ctrl, _buff_retreat(ctrl, iter->index, 1)) + 1));
+    iter->index = _buff_retreat(ctrl, iter->index, count);
+    span->buff  = ctrl->buff + _buff_offset(ctrl, iter->index);
+  }
+  else
+  {
+    count       = MIN(iter->count, _buff_contiguous(ctrl, iter->index));
+    span->buff  = ctrl->buff + _buff_offset(ctrl, iter->index);
+    iter->index = _buff_advance(ctrl, iter->index, count);
+  }
+  span->size   = count;
+  iter->count -= count;
+  return EMBLIB32_OK;
+}
+
+uint32_t buff_iter_end(t_buff_iter* iter)
+{
+  t_buff* ctrl;
+
+  /* Sanity check */
+  if (!iter || !iter->ctrl)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  ctrl        = iter->ctrl;
+  iter->ctrl  = NULL;
+  iter->count = 0;
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t buff_peek_span(t_buff* ctrl, t_buff_span* first, t_buff_span* second)
+{
+  size_t head;
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !first || !(ctrl->mode & BUFF_OPMODE_R_FIFO))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Split the stored items at the wrap point */
+  head        = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  count       = _buff_stored(ctrl, head, ATOMIC_LOAD_ACQUIRE(&ctrl->tail));
+  first->buff = ctrl->buff + _buff_offset(ctrl, head);
+  first->size = MIN(count, _buff_contiguous(ctrl, head));
+  if (second)
+  {
+    second->buff = ctrl->buff;
+    second->size = count - first->size;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  return (count == 0)? EMBLIB32_ERROR_BUFFER_EMPTY : EMBLIB32_OK;
+}
+
+uint32_t buff_consume(t_buff* ctrl, size_t size)
+{
+  uint32_t status = EMBLIB32_OK;
+  size_t   head;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !(ctrl->mode & BUFF_OPMODE_R_FIFO))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Release the processed items */
+  head = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  if (size > _buff_stored(ctrl, head, ATOMIC_LOAD_ACQUIRE(&ctrl->tail)))
+  {
+    status = EMBLIB32_ERROR_PARAMETER;
+  }
+  else
+  {
+    ATOMIC_STORE_RELEASE(&ctrl->head, _buff_advance(ctrl, head, size));
+    BUFF_STATS_ADD(ctrl, popped, size);
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  if ((status == EMBLIB32_OK) && (size != 0))
+  {
+    _buff_popped(ctrl);
+  }
+  return status;
+}
+
+uint32_t buff_sync_producer(t_buff* ctrl, size_t remaining)
+{
+  uint32_t status = EMBLIB32_OK;
+  size_t   position;
+  size_t   written;
+  size_t   stored;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !(ctrl->mode & BUFF_OPMODE_DMA) || (remaining > ctrl->buff_size))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* DMA write position (the counter reloads once it reaches zero) */
+  position = (remaining == 0)? 0 : (ctrl->buff_size - remaining);
+
+  _buff_acquire(ctrl);
+
+  /* Items written since the last call */
+  written = _buff_position(ctrl, ctrl->tail);
+  written = (position >= written)? (position - written) : (position + ctrl->buff_size - written);
+  stored  = _buff_stored(ctrl, ctrl->head, ctrl->tail);
+  ctrl->tail = _buff_advance(ctrl, ctrl->tail, written);
+
+  /* Overrun: keep the newest items, the DMA is about to overwrite the next one */
+  if ((stored + written) >= ctrl->buff_size)
+  {
+    ctrl->head = _buff_retreat(ctrl, ctrl->tail, (ctrl->buff_size - 1));
+    BUFF_STATS_ADD(ctrl, dropped, (stored + written + 1 - ctrl->buff_size));
+    status = EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+  BUFF_STATS_ADD(ctrl, pushed, written);
+  BUFF_STATS_PEAK(ctrl, ctrl->head, ctrl->tail);
+
+  _buff_release(ctrl);
+
+  /* Wake up the consumers */
+  if (written != 0)
+  {
+    _buff_pushed(ctrl);
+  }
+  return status;
+}
+
+#if BUFF_ENABLE_STATS == 1U
+uint32_t buff_get_stats(t_buff* ctrl, t_buff_stats* stats)
+{
+  /* Sanity check */
+  if (!ctrl || !stats)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Snapshot */
+  memcpy(stats, &ctrl->stats, sizeof(t_buff_stats));
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  return EMBLIB32_OK;
+}
+
+uint32_t buff_reset_stats(t_buff* ctrl)
+{
+  uint32_t lock_start;
+
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_acquire(ctrl);
+  }
+
+  /* Reset (keep the ongoing lock measurement) */
+  lock_start = ctrl->stats.lock_start;
+  memset(&ctrl->stats, 0, sizeof(t_buff_stats));
+  ctrl->stats.lock_start = lock_start;
+  ctrl->stats.peak       = _buff_stored(ctrl, ATOMIC_LOAD_ACQUIRE(&ctrl->head), ATOMIC_LOAD_ACQUIRE(&ctrl->tail));
+
+  if (!(ctrl->mode & BUFF_OPMODE_SPSC))
+  {
+    _buff_release(ctrl);
+  }
+
+  return EMBLIB32_OK;
+}
+
+WEAK uint32_t buff_stats_clock(void)
+{
+#if EMBLIB32_HOST
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((now.tv_sec * 1000000U) + (now.tv_nsec / 1000U));
+#else
+  return 0;
+#endif
+}
+#endif
+
+bool buff_is_full(const t_buff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+
+  return _buff_stored(ctrl, ATOMIC_LOAD_ACQUIRE(&ctrl->head), ATOMIC_LOAD_ACQUIRE(&ctrl->tail)) == ctrl->buff_size;
+}
+
+bool buff_is_empty(const t_buff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+  
+  return ATOMIC_LOAD_ACQUIRE(&ctrl->head) == ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+}
+
+size_t buff_get_size(const t_buff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+  
+  return ctrl->buff_size;
+}
+
+size_t buff_get_count(const t_buff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+  
+  return _buff_stored(ctrl, ATOMIC_LOAD_ACQUIRE(&ctrl->head), ATOMIC_LOAD_ACQUIRE(&ctrl->tail));
+}
+
+size_t buff_get_available(const t_buff* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+  
+  return ctrl->buff_size - _buff_stored(ctrl, ATOMIC_LOAD_ACQUIRE(&ctrl->head), ATOMIC_LOAD_ACQUIRE(&ctrl->tail));
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Pushes an item into the buffer
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check.
+ * @param ctrl Buffer controller
+ * @param item Incoming item
+ * @return Error code
+ */
+static uint32_t _buff_push_backend(t_buff* ctrl, const void* item)
+{
+  /* Handle overflow */
+  if (!(ctrl->mode & BUFF_OPMODE_W_OVERFLOW) && buff_is_full(ctrl))
+  {
+    BUFF_STATS_ADD(ctrl, dropped, 1);
+    return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+
+  /* Handle read offset (drop the oldest item) */
+  if (buff_is_full(ctrl))
+  {
+    ctrl->head = _buff_advance(ctrl, ctrl->head, 1);
+    BUFF_STATS_ADD(ctrl, dropped, 1);
+  }
+
+  /* Handle push */
+  if (ctrl->mode & BUFF_OPMODE_R_PRIORITY)
+  {
+    _buff_heap_push(ctrl, item);
+  }
+  else
+  {
+    _buff_copy(ctrl, (ctrl->buff + _buff_offset(ctrl, ctrl->tail)), item);
+    ctrl->tail = _buff_advance(ctrl, ctrl->tail, 1);
+  }
+  BUFF_STATS_ADD(ctrl, pushed, 1);
+  BUFF_STATS_PEAK(ctrl, ctrl->head, ctrl->tail);
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Pops an item from the buffer
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check.
+ * @param ctrl Buffer controller
+ * @param item  Receiving item
+ * @return Error code
+ */
+static uint32_t _buff_pop_backend(t_buff* ctrl, void* item)
+{
+  /* Handle empty */
+  if (buff_is_empty(ctrl))
+  {
+    memset(item, 0x00, ctrl->item_size);
+    BUFF_STATS_ADD(ctrl, empty_pops, 1);
+    return EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+
+  /* Handle read */
+  if (ctrl->mode & BUFF_OPMODE_R_PRIORITY)
+  {
+    _buff_heap_pop(ctrl, item);
+  }
+  else if (ctrl->mode & BUFF_OPMODE_R_FIFO)
+  {
+    _buff_copy(ctrl, item, (ctrl->buff + _buff_offset(ctrl, ctrl->head)));
+    ctrl->head = _buff_advance(ctrl, ctrl->head, 1);
+  }
+  else
+  {
+    ctrl->tail = _buff_retreat(ctrl, ctrl->tail, 1);
+    _buff_copy(ctrl, item, (ctrl->buff + _buff_offset(ctrl, ctrl->tail)));
+  }
+  BUFF_STATS_ADD(ctrl, popped, 1);
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Pushes an item into a lock-free SPSC buffer
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check. Only the producer context may call it.
+ *        The tail is published with release ordering once the item is fully written.
+ * @param ctrl Buffer controller
+ * @param item Incoming item
+ * @return Error code
+ */
+static uint32_t _buff_spsc_push_backend(t_buff* ctrl, const void* item)
+{
+  size_t tail = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  size_t head = ATOMIC_LOAD_ACQUIRE(&ctrl->head);
+
+  /* Handle overflow */
+  if (_buff_stored(ctrl, head, tail) == ctrl->buff_size)
+  {
+    BUFF_STATS_ADD(ctrl, dropped, 1);
+    return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+
+  /* Handle push */
+  _buff_copy(ctrl, (ctrl->buff + _buff_offset(ctrl, tail)), item);
+  tail = _buff_advance(ctrl, tail, 1);
+  ATOMIC_STORE_RELEASE(&ctrl->tail, tail);
+  BUFF_STATS_ADD(ctrl, pushed, 1);
+  BUFF_STATS_PEAK(ctrl, head, tail);
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Pops an item from a lock-free SPSC buffer
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check. Only the consumer context may call it.
+ *        The head is published with release ordering once the item is fully read.
+ * @param ctrl Buffer controller
+ * @param item Receiving item
+ * @return Error code
+ */
+static uint32_t _buff_spsc_pop_backend(t_buff* ctrl, void* item)
+{
+  size_t head = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  size_t tail = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+
+  /* Handle empty */
+  if (head == tail)
+  {
+    memset(item, 0x00, ctrl->item_size);
+    BUFF_STATS_ADD(ctrl, empty_pops, 1);
+    return EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+
+  /* Handle read */
+  _buff_copy(ctrl, item, (ctrl->buff + _buff_offset(ctrl, head)));
+  ATOMIC_STORE_RELEASE(&ctrl->head, _buff_advance(ctrl, head, 1));
+  BUFF_STATS_ADD(ctrl, popped, 1);
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Pushes several items into the buffer
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check.
+ *        Data is moved with at most two copies (before and after the wrap point) and the indexes are
+ *        updated once, so it is also valid for the SPSC producer.
+ * @param ctrl Buffer controller
+ * @param buff Incoming array of items
+ * @param size Number of items to push
+ * @return Number of items pushed
+ */
+static size_t _buff_push_chunk_backend(t_buff* ctrl, const uint8_t* buff, size_t size)
+{
+  size_t tail  = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  size_t head  = ATOMIC_LOAD_ACQUIRE(&ctrl->head);
+  size_t space = ctrl->buff_size - _buff_stored(ctrl, head, tail);
+  size_t count = size;
+
+  if (ctrl->mode & BUFF_OPMODE_W_OVERFLOW)
+  {
+    /* Only the newest items fit */
+    if (size > ctrl->buff_size)
+    {
+      BUFF_STATS_ADD(ctrl, dropped, (size - ctrl->buff_size));
+      buff += (size - ctrl->buff_size) * ctrl->item_size;
+      size  = ctrl->buff_size;
+    }
+    /* Drop the oldest items */
+    if (size > space)
+    {
+      BUFF_STATS_ADD(ctrl, dropped, (size - space));
+      ctrl->head = _buff_advance(ctrl, head, (size - space));
+      head       = ctrl->head;
+    }
+  }
+  else
+  {
+    BUFF_STATS_ADD(ctrl, dropped, (size - MIN(size, space)));
+    size  = MIN(size, space);
+    count = size;
+  }
+
+  /* Handle push */
+  if (ctrl->mode & BUFF_OPMODE_R_PRIORITY)
+  {
+    for (size_t idx = 0; idx < size; idx++)
+    {
+      _buff_heap_push(ctrl, (buff + (idx * ctrl->item_size)));
+    }
+    tail = ctrl->tail;
+  }
+  else
+  {
+    _buff_write(ctrl, tail, buff, size);
+    tail = _buff_advance(ctrl, tail, size);
+    ATOMIC_STORE_RELEASE(&ctrl->tail, tail);
+  }
+  BUFF_STATS_ADD(ctrl, pushed, size);
+  BUFF_STATS_PEAK(ctrl, head, tail);
+  return count;
+}
+
+/**
+ * @brief Pops several items from the buffer
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check.
+ *        On FIFO mode data is moved with at most two copies and the head is updated once, so it is
+ *        also valid for the SPSC consumer. On LIFO mode items are copied one by one (reversed order)
+ *        and on PRIORITY mode they are removed from the heap one by one (priority order).
+ * @param ctrl Buffer controller
+ * @param buff Receiving array of items
+ * @param size Number of items to pop
+ * @return Number of items popped
+ */
+static size_t _buff_pop_chunk_backend(t_buff* ctrl, uint8_t* buff, size_t size)
+{
+  size_t head  = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  size_t tail  = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+  size_t count = MIN(size, _buff_stored(ctrl, head, tail));
+
+  /* Handle read */
+  if (ctrl->mode & BUFF_OPMODE_R_PRIORITY)
+  {
+    for (size_t idx = 0; idx < count; idx++)
+    {
+      _buff_heap_pop(ctrl, (buff + (idx * ctrl->item_size)));
+    }
+  }
+  else if (ctrl->mode & BUFF_OPMODE_R_FIFO)
+  {
+    _buff_read(ctrl, head, buff, count);
+    ATOMIC_STORE_RELEASE(&ctrl->head, _buff_advance(ctrl, head, count));
+  }
+  else
+  {
+    for (size_t idx = 0; idx < count; idx++)
+    {
+      tail = _buff_retreat(ctrl, tail, 1);
+      _buff_copy(ctrl, (buff + (idx * ctrl->item_size)), (ctrl->buff + _buff_offset(ctrl, tail)));
+    }
+    ctrl->tail = tail;
+  }
+  BUFF_STATS_ADD(ctrl, popped, count);
+  BUFF_STATS_ADD(ctrl, empty_pops, (count == 0));
+  return count;
+}
+
+/**
+ * @brief Pushes the items of several segments into the buffer (all or nothing)
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check.
+ *        The room for every item is made before writing, so the tail is published once (SPSC consumers never
+ *        see a partial transfer).
+ * @param ctrl      Buffer controller
+ * @param iov       Incoming segments
+ * @param iov_count Number of segments
+ * @param total     Number of items on all the segments
+ * @return Error code
+ */
+static uint32_t _buff_push_iov_backend(t_buff* ctrl, const t_buff_span* iov, size_t iov_count, size_t total)
+{
+  size_t tail  = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  size_t head  = ATOMIC_LOAD_ACQUIRE(&ctrl->head);
+  size_t space = ctrl->buff_size - _buff_stored(ctrl, head, tail);
+
+  /* Handle overflow */
+  if ((total > ctrl->buff_size) || ((total > space) && !(ctrl->mode & BUFF_OPMODE_W_OVERFLOW)))
+  {
+    BUFF_STATS_ADD(ctrl, dropped, total);
+    return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+
+  /* Handle read offset (drop the oldest items) */
+  if (total > space)
+  {
+    BUFF_STATS_ADD(ctrl, dropped, (total - space));
+    ctrl->head = _buff_advance(ctrl, head, (total - space));
+    head       = ctrl->head;
+  }
+
+  /* Handle push */
+  for (size_t seg = 0; seg < iov_count; seg++)
+  {
+    if (ctrl->mode & BUFF_OPMODE_R_PRIORITY)
+    {
+      for (size_t idx = 0; idx < iov[seg].size; idx++)
+      {
+        _buff_heap_push(ctrl, ((const uint8_t*)iov[seg].buff + (idx * ctrl->item_size)));
+      }
+      tail = ctrl->tail;
+    }
+    else
+    {
+      _buff_write(ctrl, tail, (const uint8_t*)iov[seg].buff, iov[seg].size);
+      tail = _buff_advance(ctrl, tail, iov[seg].size);
+    }
+  }
+  ATOMIC_STORE_RELEASE(&ctrl->tail, tail);
+  BUFF_STATS_ADD(ctrl, pushed, total);
+  BUFF_STATS_PEAK(ctrl, head, tail);
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Pops items from the buffer into several segments (filled in order)
+ * @note  This function is the backend for the public API. It is not intended to be called directly.
+ *        This function is NOT performing any sanity check.
+ * @param ctrl      Buffer controller
+ * @param iov       Receiving segments
+ * @param iov_count Number of segments
+ * @return Number of items popped
+ */
+static size_t _buff_pop_iov_backend(t_buff* ctrl, const t_buff_span* iov, size_t iov_count)
+{
+  size_t count = 0;
+  size_t popped;
+
+  for (size_t seg = 0; seg < iov_count; seg++)
+  {
+    if (iov[seg].size == 0)
+    {
+      continue;
+    }
+    popped = _buff_pop_chunk_backend(ctrl, (uint8_t*)iov[seg].buff, iov[seg].size);
+    count += popped;
+    if (popped < iov[seg].size)
+    {
+      break;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Validates a segments array and gets its total number of items
+ * @param iov       Segments
+ * @param iov_count Number of segments
+ * @param total     Returns the number of items on all the segments
+ * @return True if every non-empty segment has a valid pointer
+ */
+static bool _buff_iov_size(const t_buff_span* iov, size_t iov_count, size_t* total)
+{
+  *total = 0;
+  for (size_t seg = 0; seg < iov_count; seg++)
+  {
+    if (!iov[seg].buff && (iov[seg].size != 0))
+    {
+      return false;
+    }
+    *total += iov[seg].size;
+  }
+  return true;
+}
+
+/**
+ * @brief Inserts an item into the priority heap
+ * @note  The heap is stored on the items array with the head fixed at zero, so the tail is the
+ *        number of items stored. The hole left by the new item is moved up until its parent goes
+ *        first, copying every parent only once (O(log n)).
+ *        This function is NOT performing any sanity check (the heap must not be full).
+ * @param ctrl Buffer controller
+ * @param item Incoming item
+ */
+static void _buff_heap_push(t_buff* ctrl, const void* item)
+{
+  size_t hole = ctrl->tail;
+  size_t parent;
+
+  /* Move the hole up */
+  while (hole > 0)
+  {
+    parent = (hole - 1) / 2;
+    if (ctrl->compare(item, (ctrl->buff + (parent * ctrl->item_size))) >= 0)
+    {
+      break;
+    }
+    _buff_copy(ctrl, (ctrl->buff + (hole * ctrl->item_size)), (ctrl->buff + (parent * ctrl->item_size)));
+    hole = parent;
+  }
+  _buff_copy(ctrl, (ctrl->buff + (hole * ctrl->item_size)), item);
+  ctrl->tail++;
+}
+
+/**
+ * @brief Removes the first item from the priority heap
+ * @note  The last item is used as reference while the hole left by the root is moved down, so no
+ *        temporary item is needed: it is copied into the hole at the end (O(log n)).
+ *        This function is NOT performing any sanity check (the heap must not be empty).
+ * @param ctrl Buffer controller
+ * @param item Receiving item
+ */
+static void _buff_heap_pop(t_buff* ctrl, void* item)
+{
+  size_t         count = ctrl->tail - 1;
+  const uint8_t* last  = ctrl->buff + (count * ctrl->item_size);
+  size_t         hole  = 0;
+  size_t         child;
+
+  /* Take the root */
+  _buff_copy(ctrl, item, ctrl->buff);
+
+  /* Move the hole down */
+  while ((child = (2 * hole) + 1) < count)
+  {
+    if (((child + 1) < count) &&
+        (ctrl->compare((ctrl->buff + ((child + 1) * ctrl->item_size)), (ctrl->buff + (child * ctrl->item_size))) < 0))
+    {
+      child++;
+    }
+    if (ctrl->compare(last, (ctrl->buff + (child * ctrl->item_size))) <= 0)
+    {
+      break;
+    }
+    _buff_copy(ctrl, (ctrl->buff + (hole * ctrl->item_size)), (ctrl->buff + (child * ctrl->item_size)));
+    hole = child;
+  }
+  if (hole != count)
+  {
+    _buff_copy(ctrl, (ctrl->buff + (hole * ctrl->item_size)), last);
+  }
+  ctrl->tail = count;
+}
+
+/**
+ * @brief Copies items into the items array starting at a given index
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @param buff  Source items
+ * @param count Number of items to copy (up to buff_size)
+ */
+static void _buff_write(t_buff* ctrl, size_t index, const uint8_t* buff, size_t count)
+{
+  size_t offset = _buff_offset(ctrl, index);
+  size_t bytes  = count * ctrl->item_size;
+  size_t first  = MIN(count, _buff_contiguous(ctrl, index)) * ctrl->item_size;
+
+  memcpy((ctrl->buff + offset), buff, first);
+  if (bytes > first)
+  {
+    memcpy(ctrl->buff, (buff + first), (bytes - first));
+  }
+}
+
+/**
+ * @brief Copies items from the items array starting at a given index
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @param buff  Destination items
+ * @param count Number of items to copy (up to buff_size)
+ */
+static void _buff_read(const t_buff* ctrl, size_t index, uint8_t* buff, size_t count)
+{
+  size_t offset = _buff_offset(ctrl, index);
+  size_t bytes  = count * ctrl->item_size;
+  size_t first  = MIN(count, _buff_contiguous(ctrl, index)) * ctrl->item_size;
+
+  memcpy(buff, (ctrl->buff + offset), first);
+  if (bytes > first)
+  {
+    memcpy((buff + first), ctrl->buff, (bytes - first));
+  }
+}
+
+/**
+ * @brief Moves an index forward
+ * @note  Indexes run on [0, 2 * buff_size) so a full buffer can be told apart from an empty one
+ *        without a shared usage counter. Power-of-two sizes are wrapped with a mask, any other
+ *        size with a compare and subtract. No division is required.
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @param count Displacement (# items, up to buff_size)
+ * @return New index
+ */
+static size_t _buff_advance(const t_buff* ctrl, size_t index, size_t count)
+{
+  if (ctrl->mask)
+  {
+    return (index + count) & ctrl->mask;
+  }
+  index += count;
+  return (index >= (ctrl->buff_size << 1))? (index - (ctrl->buff_size << 1)) : index;
+}
+
+/**
+ * @brief Moves an index backwards
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @param count Displacement (# items, up to buff_size)
+ * @return New index
+ */
+static size_t _buff_retreat(const t_buff* ctrl, size_t index, size_t count)
+{
+  if (ctrl->mask)
+  {
+    return (index - count) & ctrl->mask;
+  }
+  return (index >= count)? (index - count) : (index + (ctrl->buff_size << 1) - count);
+}
+
+/**
+ * @brief Converts an index into a storage position
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @return Position in the items array (# items)
+ */
+static size_t _buff_position(const t_buff* ctrl, size_t index)
+{
+  if (ctrl->mask)
+  {
+    return index & (ctrl->mask >> 1);
+  }
+  return (index >= ctrl->buff_size)? (index - ctrl->buff_size) : index;
+}
+
+/**
+ * @brief Converts an index into a storage offset
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @return Offset in the items array (bytes)
+ */
+static size_t _buff_offset(const t_buff* ctrl, size_t index)
+{
+  return _buff_position(ctrl, index) * ctrl->item_size;
+}
+
+/**
+ * @brief Gets the number of slots that can be accessed contiguously from an index
+ * @note  On mirrored buffers the whole buffer is always contiguous
+ * @param ctrl  Buffer controller
+ * @param index Index (# items)
+ * @return Contiguous slots (# items)
+ */
+static size_t _buff_contiguous(const t_buff* ctrl, size_t index)
+{
+  return ctrl->mirrored? ctrl->buff_size : (ctrl->buff_size - _buff_position(ctrl, index));
+}
+
+/**
+ * @brief Computes the buffer usage from a head/tail pair
+ * @param ctrl Buffer controller
+ * @param head Head index (# items)
+ * @param tail Tail index (# items)
+ * @return Buffer usage (# items)
+ */
+static size_t _buff_stored(const t_buff* ctrl, size_t head, size_t tail)
+{
+  if (ctrl->mask)
+  {
+    return (tail - head) & ctrl->mask;
+  }
+  return (tail >= head)? (tail - head) : (tail + (ctrl->buff_size << 1) - head);
+}
+
+/**
+ * @brief Signals that items were added: wakes up the consumers and checks the high watermark
+ * @note  Called after the lock is released. The watermark state flips atomically so the callback fires once
+ * @param ctrl Buffer controller
+ */
+static void _buff_pushed(t_buff* ctrl)
+{
+  bool below = false;
+
+  _buff_notify(ctrl, &ctrl->data_waiters, ctrl->data_event);
+  if ((ctrl->wm_high != 0) && (buff_get_count(ctrl) >= ctrl->wm_high) &&
+      ATOMIC_CAS_RELAXED(&ctrl->wm_above, &below, true) && ctrl->on_high)
+  {
+    ctrl->on_high(ctrl->wm_object, buff_get_count(ctrl));
+  }
+}
+
+/**
+ * @brief Signals that items were removed: wakes up the producers and checks the low watermark
+ * @note  Called after the lock is released. The low watermark only fires after the high one
+ * @param ctrl Buffer controller
+ */
+static void _buff_popped(t_buff* ctrl)
+{
+  bool above = true;
+
+  _buff_notify(ctrl, &ctrl->space_waiters, ctrl->space_event);
+  if ((ctrl->wm_high != 0) && (buff_get_count(ctrl) <= ctrl->wm_low) &&
+      ATOMIC_CAS_RELAXED(&ctrl->wm_above, &above, false) && ctrl->on_low)
+  {
+    ctrl->on_low(ctrl->wm_object, buff_get_count(ctrl));
+  }
+}
+
+/**
+ * @brief Notifies an event object (if registered) when a context waits on it
+ * @note  Takes one registration per notification, so the event never holds more notifications than waiters
+ * @param ctrl    Buffer controller
+ * @param waiters Contexts waiting on the event, not notified yet
+ * @param event   Event object
+ */
+static void _buff_notify(const t_buff* ctrl, volatile size_t* waiters, void* event)
+{
+  if (!ctrl->notify || !event)
+  {
+    return;
+  }
+
+  /* Pairs with buff_wait_begin: either the waiter sees the new state or this sees the registration */
+  ATOMIC_FENCE_SEQ_CST();
+  if (_buff_waiter_take(waiters))
+  {
+    ctrl->notify(event);
+  }
+}
+
+/**
+ * @brief Takes one registration from a waiter counter
+ * @param waiters Contexts waiting on an event, not notified yet
+ * @return True if taken, false if there were none
+ */
+static bool _buff_waiter_take(volatile size_t* waiters)
+{
+  size_t count = ATOMIC_LOAD_RELAXED(waiters);
+
+  while (count != 0)
+  {
+    if (ATOMIC_CAS_RELAXED(waiters, &count, (count - 1U)))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Computes the checksum of a persistent store header (FNV-1a)
+ * @param store Persistent store
+ * @return Checksum
+ */
+static uint32_t _buff_persist_checksum(const t_buff_persist* store)
+{
+  const uint32_t fields[] = {store->magic, store->generation, store->layout, store->buff_size, store->item_size, store->mode};
+  uint32_t       hash     = 0x811C9DC5U;
+
+  for (size_t idx = 0; idx < ARRAY_SIZE(fields); idx++)
+  {
+    for (size_t shift = 0; shift < 32U; shift += 8U)
+    {
+      hash ^= (fields[idx] >> shift) & 0xFFU;
+      hash *= 0x01000193U;
+    }
+  }
+  return hash;
+}
+
+#if BUFF_TXN_SUPPORT == 1U
+/**
+ * @brief Checks if the current context holds a transaction on the buffer
+ * @note  The context is only identified while some transaction is open: the common path is a single load
+ * @param ctrl Buffer controller
+ * @return True if the current context is the transaction owner
+ */
+static inline bool _buff_txn_held(const t_buff* ctrl)
+{
+  uintptr_t owner = ATOMIC_LOAD_RELAXED(&ctrl->txn_owner);
+
+  return (owner != 0U) && (owner == BUFF_CONTEXT_ID());
+}
+#endif
+
+/**
+ * @brief Takes the buffer lock (strategy selected by BUFF_LOCK_STRATEGY)
+ * @note  Skipped if the current context holds a transaction
+ * @param ctrl Buffer controller
+ */
+static inline void _buff_acquire(t_buff* ctrl)
+{
+#if BUFF_TXN_SUPPORT == 1U
+  if (_buff_txn_held(ctrl))
+  {
+    return;
+  }
+#endif
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_CALLBACK
+  if (!ctrl->lock)
+  {
+    return;
+  }
+  ctrl->lock(ctrl->object, true);
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_NONE
+  return;
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL
+  uint32_t state;
+  BUFF_CRITICAL_ENTER(state);
+  ctrl->irq_state = state;
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_SPINLOCK
+  while (ATOMIC_EXCHANGE_ACQ_REL(&ctrl->spin, 1U) != 0U)
+  {
+    /* Wait on a plain load, the exchange keeps the cache line busy */
+    while (ATOMIC_LOAD_RELAXED(&ctrl->spin) != 0U)
+    {
+    }
+  }
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_MUTEX
+  if (!ctrl->object)
+  {
+    return;
+  }
+  BUFF_MUTEX_LOCK(ctrl->object);
+#else
+  #error "Unknown BUFF_LOCK_STRATEGY"
+#endif
+#if (BUFF_ENABLE_STATS == 1U) && (BUFF_LOCK_STRATEGY != BUFF_LOCK_NONE)
+  ctrl->stats.lock_start = buff_stats_clock();
+#endif
+}
+
+/**
+ * @brief Releases the buffer lock (strategy selected by BUFF_LOCK_STRATEGY)
+ * @note  Skipped if the current context holds a transaction
+ * @param ctrl Buffer controller
+ */
+static inline void _buff_release(t_buff* ctrl)
+{
+#if BUFF_TXN_SUPPORT == 1U
+  if (_buff_txn_held(ctrl))
+  {
+    return;
+  }
+#endif
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_CALLBACK
+  if (!ctrl->lock)
+  {
+    return;
+  }
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_MUTEX
+  if (!ctrl->object)
+  {
+    return;
+  }
+#endif
+#if (BUFF_ENABLE_STATS == 1U) && (BUFF_LOCK_STRATEGY != BUFF_LOCK_NONE)
+  ctrl->stats.lock_time += buff_stats_clock() - ctrl->stats.lock_start;
+#endif
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_CALLBACK
+  ctrl->lock(ctrl->object, false);
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL
+  BUFF_CRITICAL_EXIT(ctrl->irq_state);
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_SPINLOCK
+  ATOMIC_STORE_RELEASE(&ctrl->spin, 0U);
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_MUTEX
+  BUFF_MUTEX_UNLOCK(ctrl->object);
+#endif
+}
+
+#if (BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL) && (EMBLIB32_HOST)
+/**
+ * @brief Enters the emulated critical section (HOST: one global spinlock stands for the interrupt mask)
+ */
+static void _buff_critical_enter(void)
+{
+  while (ATOMIC_EXCHANGE_ACQ_REL(&_buff_critical, 1U) != 0U)
+  {
+    while (ATOMIC_LOAD_RELAXED(&_buff_critical) != 0U)
+    {
+    }
+  }
+}
+
+/**
+ * @brief Leaves the emulated critical section
+ */
+static void _buff_critical_exit(void)
+{
+  ATOMIC_STORE_RELEASE(&_buff_critical, 0U);
+}
+#endif
+
+#if BUFF_ENABLE_STATS == 1U
+/**
+ * @brief Tracks the peak occupancy
+ * @param ctrl Buffer controller
+ * @param head Head index
+ * @param tail Tail index
+ */
+static void _buff_stats_peak(t_buff* ctrl, size_t head, size_t tail)
+{
+  size_t stored = _buff_stored(ctrl, head, tail);
+
+  if (stored > ctrl->stats.peak)
+  {
+    ctrl->stats.peak = stored;
+  }
+}
+#endif
+
+/**
+ * @brief Copies one item
+ * @note  Inlined: the fixed sizes compile to a single load and store (unaligned safe), others use memcpy
+ * @param ctrl Buffer controller
+ * @param dst  Destination item
+ * @param src  Source item
+ */
+static inline void _buff_copy(const t_buff* ctrl, void* dst, const void* src)
+{
+  switch (ctrl->item_size)
+  {
+    case sizeof(uint8_t):
+      *(uint8_t*)dst = *(const uint8_t*)src;
+      break;
+    case sizeof(uint16_t):
+      memcpy(dst, src, sizeof(uint16_t));
+      break;
+    case sizeof(uint32_t):
+      memcpy(dst, src, sizeof(uint32_t));
+      break;
+    case sizeof(uint64_t):
+      memcpy(dst, src, sizeof(uint64_t));
+      break;
+    default:
+      memcpy(dst, src, ctrl->item_size);
+      break;
+  }
+}
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PRIVATE_Functions -->
 *//*-----------------------------------------------------------------------*//**
@@ -41,6 +41,66 @@ extern "C" {
 #define EMBLIB32_ERROR_BUFFER_INDEX     0x12U    /*!< Buffer index out of bounds */
 #define EMBLIB32_ERROR_BUFFER_OVERFLOW  0x13U    /*!< Buffer overflowed */
 
+/** Cache line size: producer and consumer state are kept on separate lines (avoids false sharing) */
+#ifndef BUFF_CACHE_LINE
+  #if EMBLIB32_HOST
+    #define BUFF_CACHE_LINE             64U
+  #else
+    #define BUFF_CACHE_LINE             4U
+  #endif
+#endif
+
+/** Mirrored storage support (virtual memory, Linux hosts only) */
+#ifndef BUFF_MIRROR_SUPPORT
+  #if (EMBLIB32_HOST) && defined(__linux__)
+    #define BUFF_MIRROR_SUPPORT         1U
+  #else
+    #define BUFF_MIRROR_SUPPORT         0U
+  #endif
+#endif
+
+/** Persistent buffers on a memory-mapped file (POSIX hosts only) */
+#ifndef BUFF_PERSIST_FILE_SUPPORT
+  #if (EMBLIB32_HOST) && (defined(__unix__) || defined(__APPLE__))
+    #define BUFF_PERSIST_FILE_SUPPORT   1U
+  #else
+    #define BUFF_PERSIST_FILE_SUPPORT   0U
+  #endif
+#endif
+
+/** Runtime statistics (occupancy, traffic and lock time counters). Disabled by default */
+#ifndef BUFF_ENABLE_STATS
+  #define BUFF_ENABLE_STATS           0U
+#endif
+
+/** Lock strategies (see BUFF_LOCK_STRATEGY) */
+#define BUFF_LOCK_CALLBACK          0U      /*!< Lock handler set with buff_set_lock (indirect call) */
+#define BUFF_LOCK_NONE              1U      /*!< No lock: single context or externally serialized */
+#define BUFF_LOCK_CRITICAL          2U      /*!< Interrupts disabled (BUFF_CRITICAL_ENTER/BUFF_CRITICAL_EXIT) */
+#define BUFF_LOCK_SPINLOCK          3U      /*!< Per-buffer spinlock (atomic exchange) */
+#define BUFF_LOCK_MUTEX             4U      /*!< RTOS mutex given as lock object (BUFF_MUTEX_LOCK/BUFF_MUTEX_UNLOCK) */
+
+/**
+ * Lock strategy used by every buffer, resolved at compile time so the lock inlines into the fast path.
+ * Except for BUFF_LOCK_CALLBACK the lock handler given to buff_set_lock is ignored
+ */
+#ifndef BUFF_LOCK_STRATEGY
+  #define BUFF_LOCK_STRATEGY          BUFF_LOCK_CALLBACK
+#endif
+
+/**
+ * Transaction support (buff_begin/buff_end). The lock owner is identified with BUFF_CONTEXT_ID(), which must be
+ * unique and non-zero for every context that may use the buffer (e.g. the current task handle). While no
+ * transaction is open, other operations only pay one load of the owner: BUFF_CONTEXT_ID() is not called
+ */
+#ifndef BUFF_TXN_SUPPORT
+  #if (EMBLIB32_HOST) || defined(BUFF_CONTEXT_ID) || (BUFF_LOCK_STRATEGY == BUFF_LOCK_NONE) || (BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL)
+    #define BUFF_TXN_SUPPORT          1U
+  #else
+    #define BUFF_TXN_SUPPORT          0U
+  #endif
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_Definitions -->
 *//*-----------------------------------------------------------------------*//**
@@ -48,6 +108,100 @@ extern "C" {
 * @{
 *//*--------------------------------------------------------------------------*/
 
+/** Align to the cache line size */
+#define BUFF_CACHE_ALIGNED    __attribute__ ((aligned(BUFF_CACHE_LINE)))
+
+/** Size of a persistent buffer store (bytes): header, controller and items array */
+#define BUFF_PERSIST_SIZE(buff_size, item_size) \
+  (sizeof(t_buff_persist) + ((buff_size) * (item_size)))
+
+/**
+ * Defines a statically sized, typed FIFO buffer: t_<name> plus <name>_init/push/pop/peek/is_empty/is_full/get_count.
+ * Item size and capacity are compile-time constants, so every function inlines down to a single typed load/store
+ * and constant index arithmetic. Like BUFF_OPMODE_SPSC, one context may push and one context may pop without lock.
+ * Usage: BUFF_DEFINE(rx_bytes, uint8_t, 64) -> t_rx_bytes rx; rx_bytes_init(&rx); rx_bytes_push(&rx, 0x55);
+ */
+#define BUFF_DEFINE(name, type, N)                                                                  \
+  typedef struct                                                                                    \
+  {                                                                                                 \
+    type            items[N];                                                                       \
+    volatile size_t tail BUFF_CACHE_ALIGNED;                                                        \
+    volatile size_t head BUFF_CACHE_ALIGNED;                                                        \
+  } t_##name;                                                                                       \
+                                                                                                    \
+  static inline size_t name##_advance(size_t index)                                                 \
+  {                                                                                                 \
+    if (((N) & ((N) - 1U)) == 0U)                                                                   \
+    {                                                                                               \
+      return (index + 1U) & ((2U * (N)) - 1U);                                                      \
+    }                                                                                               \
+    return (index == ((2U * (N)) - 1U))? 0U : (index + 1U);                                         \
+  }                                                                                                 \
+                                                                                                    \
+  static inline size_t name##_position(size_t index)                                                \
+  {                                                                                                 \
+    return (index < (N))? index : (index - (N));                                                    \
+  }                                                                                                 \
+                                                                                                    \
+  static inline void name##_init(t_##name* ctrl)                                                    \
+  {                                                                                                 \
+    ctrl->tail = 0U;                                                                                \
+    ctrl->head = 0U;                                                                                \
+  }                                                                                                 \
+                                                                                                    \
+  static inline size_t name##_get_count(const t_##name* ctrl)                                       \
+  {                                                                                                 \
+    size_t tail = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);                                                 \
+    size_t head = ATOMIC_LOAD_ACQUIRE(&ctrl->head);                                                 \
+    return (tail >= head)? (tail - head) : (tail + (2U * (N)) - head);                              \
+  }                                                                                                 \
+                                                                                                    \
+  static inline bool name##_is_empty(const t_##name* ctrl)                                          \
+  {                                                                                                 \
+    return ATOMIC_LOAD_ACQUIRE(&ctrl->tail) == ATOMIC_LOAD_ACQUIRE(&ctrl->head);                    \
+  }                                                                                                 \
+                                                                                                    \
+  static inline bool name##_is_full(const t_##name* ctrl)                                           \
+  {                                                                                                 \
+    return name##_get_count(ctrl) == (N);                                                           \
+  }                                                                                                 \
+                                                                                                    \
+  static inline uint32_t name##_push(t_##name* ctrl, type item)                                     \
+  {                                                                                                 \
+    size_t tail = ATOMIC_LOAD_RELAXED(&ctrl->tail);                                                 \
+    size_t head = ATOMIC_LOAD_ACQUIRE(&ctrl->head);                                                 \
+    if (((tail >= head)? (tail - head) : (tail + (2U * (N)) - head)) == (N))                        \
+    {                                                                                               \
+      return EMBLIB32_ERROR_BUFFER_OVERFLOW;                                                        \
+    }                                                                                               \
+    ctrl->items[name##_position(tail)] = item;                                                      \
+    ATOMIC_STORE_RELEASE(&ctrl->tail, name##_advance(tail));                                        \
+    return EMBLIB32_OK;                                                                             \
+  }                                                                                                 \
+                                                                                                    \
+  static inline uint32_t name##_peek(const t_##name* ctrl, type* item)                              \
+  {                                                                                                 \
+    size_t head = ATOMIC_LOAD_RELAXED(&ctrl->head);                                                 \
+    if (head == ATOMIC_LOAD_ACQUIRE(&ctrl->tail))                                                   \
+    {                                                                                               \
+      return EMBLIB32_ERROR_BUFFER_EMPTY;                                                           \
+    }                                                                                               \
+    *item = ctrl->items[name##_position(head)];                                                     \
+    return EMBLIB32_OK;                                                                             \
+  }                                                                                                 \
+                                                                                                    \
+  static inline uint32_t name##_pop(t_##name* ctrl, type* item)                                     \
+  {                                                                                                 \
+    size_t head = ATOMIC_LOAD_RELAXED(&ctrl->head);                                                 \
+    if (head == ATOMIC_LOAD_ACQUIRE(&ctrl->tail))                                                   \
+    {                                                                                               \
+      return EMBLIB32_ERROR_BUFFER_EMPTY;                                                           \
+    }                                                                                               \
+    *item = ctrl->items[name##_position(head)];                                                     \
+    ATOMIC_STORE_RELEASE(&ctrl->head, name##_advance(head));                                        \
+    return EMBLIB32_OK;                                                                             \
+  }
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_Macros -->
 *//*-----------------------------------------------------------------------*//**
@@ -61,9 +215,48 @@ typedef enum
   BUFF_OPMODE_R_FIFO      = 0x01,    /*!< R_FIFO: Reading mode: FIFO -> Queue */
   BUFF_OPMODE_R_LIFO      = 0x02,    /*!< R_LIFO: Reading mode: LIFO -> Stack */
   BUFF_OPMODE_W_OVERFLOW  = 0x04,    /*!< W_OVF:  Write mode:   Overflow > Oldest items are overwritten */
+  BUFF_OPMODE_SPSC        = 0x08,    /*!< SPSC:   Access mode:  Lock-free single producer / single consumer (FIFO only, no overflow) */
+  BUFF_OPMODE_R_PRIORITY  = 0x10,    /*!< R_PRIO: Reading mode: Priority -> Binary heap (see buff_set_priority) */
+  BUFF_OPMODE_DMA         = 0x20,    /*!< DMA:    Write mode:   Items written by a circular DMA (FIFO only, see buff_sync_producer) */
   BUFF_OPMODE_DEFAULT     = BUFF_OPMODE_R_FIFO | BUFF_OPMODE_W_OVERFLOW,
 } t_buff_opmode;
 
+/** Enumeration with the buffer events a context can wait for (see buff_wait_begin) */
+typedef enum
+{
+  BUFF_WAIT_DATA          = 0x01,    /*!< Items added (data event) */
+  BUFF_WAIT_SPACE         = 0x02,    /*!< Items removed (space event) */
+} t_buff_wait;
+
+/**
+ * @brief Watermark callback
+ * @param object  Watermark object
+ * @param count   Items stored when the watermark was crossed (# items)
+ */
+typedef void (*t_buff_watermark)(void* object, size_t count);
+
+/**
+ * @brief Item comparator (BUFF_OPMODE_R_PRIORITY)
+ * @param a       Item
+ * @param b       Item
+ * @return Negative if a must be popped before b, zero if both have the same priority, positive otherwise
+ */
+typedef int (*t_buff_compare)(const void* a, const void* b);
+
+#if BUFF_ENABLE_STATS == 1U
+/** Buffer runtime statistics (counters wrap around) */
+typedef struct
+{
+  size_t          peak;       /*!< Highest occupancy seen (# items) */
+  uint32_t        pushed;     /*!< Items pushed */
+  uint32_t        popped;     /*!< Items popped / consumed */
+  uint32_t        dropped;    /*!< Items lost to overflow: oldest items overwritten or pushes rejected */
+  uint32_t        empty_pops; /*!< Pop attempts on an empty buffer */
+  uint32_t        lock_time;  /*!< Time spent holding the lock (buff_stats_clock ticks) */
+  uint32_t        lock_start; /*!< Lock acquisition timestamp (internal) */
+} t_buff_stats;
+#endif
+
 /** Generic buff controller structure */
 typedef struct
 {
@@ -72,14 +265,77 @@ typedef struct
   size_t          buff_size;  /*!< Buffer size (# items) */
   size_t          item_size;  /*!< Item size (bytes) */
   size_t          capacity;   /*!< Buffer size (bytes) */
-  volatile size_t stored;     /*!< Buffer usage (bytes) */
-  volatile size_t head;       /*!< Oldest item */
-  volatile size_t tail;       /*!< Store new items */
+  size_t          mask;       /*!< Index mask (2 * buff_size - 1) if buff_size is a power of two, zero otherwise */
+  bool            mirrored;   /*!< Items array mapped twice back-to-back (no wrap point) */
   /* RTOS support */
   t_rtos_lock     lock;       /*!< Lock handler function */
   void*           object;     /*!< Lock object */
+#if BUFF_LOCK_STRATEGY == BUFF_LOCK_SPINLOCK
+  volatile uint32_t spin;     /*!< Spinlock */
+#elif BUFF_LOCK_STRATEGY == BUFF_LOCK_CRITICAL
+  uint32_t        irq_state;  /*!< Interrupt state saved when entering the critical section */
+#endif
+#if BUFF_TXN_SUPPORT == 1U
+  volatile uintptr_t txn_owner; /*!< Context holding the transaction (zero if none) */
+  uint32_t        txn_depth;  /*!< Transaction nesting level */
+#endif
+  t_rtos_wait     wait;       /*!< Wait handler function */
+  t_rtos_notify   notify;     /*!< Notify handler function */
+  void*           data_event; /*!< Event notified when items are added (consumers wait on it) */
+  void*           space_event; /*!< Event notified when items are removed (producers wait on it) */
+  volatile size_t data_waiters; /*!< Contexts waiting on the data event, not notified yet */
+  volatile size_t space_waiters; /*!< Contexts waiting on the space event, not notified yet */
+  /* Priority */
+  t_buff_compare  compare;    /*!< Item comparator (BUFF_OPMODE_R_PRIORITY) */
+  /* Watermarks */
+  t_buff_watermark on_high;   /*!< Called once when the occupancy rises to wm_high */
+  t_buff_watermark on_low;    /*!< Called once when the occupancy falls to wm_low (after on_high) */
+  void*           wm_object;  /*!< Watermark object */
+  size_t          wm_high;    /*!< High watermark (# items, zero if disabled) */
+  size_t          wm_low;     /*!< Low watermark (# items) */
+  volatile bool   wm_above;   /*!< High watermark reached and low watermark not yet */
+#if BUFF_ENABLE_STATS == 1U
+  t_buff_stats    stats;      /*!< Runtime statistics */
+#endif
+  /* Producer state */
+  volatile size_t tail BUFF_CACHE_ALIGNED;  /*!< Store new items (# items, in range [0, 2 * buff_size)) */
+  /* Consumer state */
+  volatile size_t head BUFF_CACHE_ALIGNED;  /*!< Oldest item (# items, in range [0, 2 * buff_size)) */
 } t_buff;
 
+/**
+ * Persistent buffer store, placed on a region that survives resets (no-init RAM section or memory-mapped file).
+ * The header describes the layout and is protected by a checksum, the controller keeps the head and tail
+ * indexes. The items array follows the store (see BUFF_PERSIST_SIZE).
+ */
+typedef struct
+{
+  uint32_t        magic;      /*!< Store signature */
+  uint32_t        generation; /*!< Times the store was recovered */
+  uint32_t        layout;     /*!< Controller size (detects firmware changes) */
+  uint32_t        buff_size;  /*!< Buffer size (# items) */
+  uint32_t        item_size;  /*!< Item size (bytes) */
+  uint32_t        mode;       /*!< Operation mode */
+  uint32_t        checksum;   /*!< Header checksum */
+  t_buff          buff;       /*!< Buffer controller */
+} t_buff_persist;
+
+/** Contiguous region of items */
+typedef struct
+{
+  void*           buff;       /*!< First item */
+  size_t          size;       /*!< Number of items */
+} t_buff_span;
+
+/** Buffer iterator: walks the stored items in read order while holding the lock (see buff_iter_begin) */
+typedef struct
+{
+  t_buff*         ctrl;       /*!< Buffer controller */
+  size_t          index;      /*!< Next item index (LIFO: one past the next item) */
+  size_t          count;      /*!< Items left */
+  bool            reverse;    /*!< Walk from the newest item (LIFO) */
+} t_buff_iter;
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_Types -->
 *//*-----------------------------------------------------------------------*//**
@@ -97,18 +353,88 @@ typedef struct
 /**
  * @brief Initializes a buffer instance
  * @note  This function is thread unsafe. Use with care
+ *        On BUFF_OPMODE_SPSC the lock is never taken: only one context may push and only one context may pop.
+ *        This mode can't be combined with BUFF_OPMODE_R_LIFO or BUFF_OPMODE_W_OVERFLOW
+ *        On BUFF_OPMODE_R_PRIORITY the items array holds a binary heap ordered by the buff_set_priority comparator.
+ *        This mode can't be combined with any other mode
+ *        On BUFF_OPMODE_DMA the items array is written by a circular DMA and only buff_sync_producer adds items.
+ *        It requires BUFF_OPMODE_R_FIFO and can't be combined with any other mode
  * @param ctrl      Buffer controller
  * @param buff      Array of items
  * @param buff_size Buffer size (# items)
  * @param item_size Item size (bytes)
+ *                  1, 2, 4 and 8 byte items are copied with a single load and store
  * @param mode      Operation mode (see t_buff_mode)
+ *                  Power-of-two buffer sizes use masking for the index arithmetic
  * @param clear     True to purge the items buffer (fill with zeros)
  * @return Error code
  */
 uint32_t buff_init(t_buff* ctrl, void* buff, size_t buff_size, size_t item_size, uint16_t mode, bool clear);
 
+/**
+ * @brief Initializes or recovers a persistent buffer (see t_buff_persist). Use the store buff member afterwards
+ * @note  This function is thread unsafe. Use with care
+ *        If the store holds a valid buffer with the same layout, its items are kept and the generation is
+ *        incremented. Otherwise the buffer starts empty (the items array is not cleared). Handlers (lock, notify,
+ *        watermarks...) must be set again after every call. BUFF_OPMODE_R_PRIORITY is not supported: heap
+ *        updates are not crash-safe
+ * @param store     Persistent store (BUFF_PERSIST_SIZE(buff_size, item_size) bytes, e.g. a no-init section)
+ * @param buff_size Buffer size (# items)
+ * @param item_size Item size (bytes)
+ * @param mode      Operation mode
+ * @param recovered Returns true if the items were recovered (optional)
+ * @return Error code
+ */
+uint32_t buff_init_persistent(t_buff_persist* store, size_t buff_size, size_t item_size, uint16_t mode, bool* recovered);
+
+#if BUFF_PERSIST_FILE_SUPPORT == 1U
+/**
+ * @brief Maps a file as persistent store (created if it doesn't exist). Use buff_init_persistent on it
+ * @note  The contents survive a crash of the process, the OS writes them back to the file on its own
+ * @param store     Returns the mapped store
+ * @param path      File path
+ * @param buff_size Buffer size (# items)
+ * @param item_size Item size (bytes)
+ * @return Error code
+ */
+uint32_t buff_persist_map(t_buff_persist** store, const char* path, size_t buff_size, size_t item_size);
+
+/**
+ * @brief Unmaps a persistent store mapped with buff_persist_map (the file is kept)
+ * @note  Must be called after buff_init_persistent
+ * @param store     Persistent store
+ * @return Error code
+ */
+uint32_t buff_persist_unmap(t_buff_persist* store);
+#endif /* BUFF_PERSIST_FILE_SUPPORT */
+
+#if BUFF_MIRROR_SUPPORT == 1U
+/**
+ * @brief Initializes a buffer instance on a mirrored items array
+ * @note  This function is thread unsafe. Use with care
+ *        The items array is allocated by mapping the same memory twice back-to-back, so every region of up to
+ *        buff_size items is contiguous: chunk, reserve and span operations never split at the wrap point.
+ *        The buffer size is rounded up so the array size is a multiple of the page size
+ * @param ctrl      Buffer controller
+ * @param buff_size Buffer size (# items, minimum)
+ * @param item_size Item size (bytes)
+ * @param mode      Operation mode (see t_buff_mode)
+ * @return Error code
+ */
+uint32_t buff_init_mirrored(t_buff* ctrl, size_t buff_size, size_t item_size, uint16_t mode);
+
+/**
+ * @brief Releases the mirrored items array of a buffer instance
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl      Buffer controller
+ * @return Error code
+ */
+uint32_t buff_deinit_mirrored(t_buff* ctrl);
+#endif /* BUFF_MIRROR_SUPPORT */
+
 /**
  * @brief Configures the buffer lock function
+ * @note  Only BUFF_LOCK_CALLBACK calls the lock function. BUFF_LOCK_MUTEX uses the object as mutex (lock may be NULL)
  * @param ctrl      Buffer controller
  * @param lock      Lock function
  * @param object    Lock object
@@ -124,8 +450,95 @@ uint32_t buff_set_lock(t_buff* ctrl, t_rtos_lock lock, void* object);
  */
 uint32_t buff_lock(t_buff* ctrl, bool lock);
 
+#if BUFF_TXN_SUPPORT == 1U
+/**
+ * @brief Starts a transaction: the buffer stays locked until buff_end, so several operations run under one acquisition
+ * @note  Any buffer function called from the same context skips the lock. Transactions may be nested.
+ *        Blocking functions (buff_push_wait/buff_pop_wait) must not be called inside a transaction.
+ *        Not available on BUFF_OPMODE_SPSC (there is no lock)
+ * @param ctrl      Buffer controller
+ * @return Error code
+ */
+uint32_t buff_begin(t_buff* ctrl);
+
+/**
+ * @brief Ends a transaction started with buff_begin (releases the lock on the outermost call)
+ * @param ctrl      Buffer controller
+ * @return Error code (EMBLIB32_ERROR_PARAMETER if the context doesn't hold a transaction)
+ */
+uint32_t buff_end(t_buff* ctrl);
+#endif /* BUFF_TXN_SUPPORT */
+
+/**
+ * @brief Set the wait/notify function handlers for the buffer (enables buff_push_wait and buff_pop_wait)
+ * @note  Events are notified after the lock is released, only if a context waits on them (see buff_wait_begin).
+ *        Either event may be NULL if that direction never blocks
+ * @param ctrl        Buffer controller
+ * @param wait        Wait function handler
+ * @param notify      Notify function handler
+ * @param data_event  Event object notified when items are added
+ * @param space_event Event object notified when items are removed
+ * @return Error code
+ */
+uint32_t buff_set_notify(t_buff* ctrl, t_rtos_wait wait, t_rtos_notify notify, void* data_event, void* space_event);
+
+/**
+ * @brief Registers a context that is about to wait on the buffer events
+ * @note  Each push or pop notifies one registered context at most, so no notification is left behind once nobody
+ *        waits. Register before checking the buffer state, then wait on the event: a successful wait consumes the
+ *        registration, otherwise drop it with buff_wait_end. buff_push_wait and buff_pop_wait do it internally
+ * @param ctrl      Buffer controller
+ * @param events    Events waited for (see t_buff_wait)
+ * @return Error code
+ */
+uint32_t buff_wait_begin(t_buff* ctrl, uint32_t events);
+
+/**
+ * @brief Drops the registrations made with buff_wait_begin
+ * @note  A registration already taken by a push or pop can't be dropped: its notification is (or is about to be)
+ *        on the event and the caller must consume it with a blocking wait
+ * @param ctrl      Buffer controller
+ * @param events    Events waited for (see t_buff_wait)
+ * @return Number of notifications the caller must still consume
+ */
+size_t buff_wait_end(t_buff* ctrl, uint32_t events);
+
+/**
+ * @brief Set the item comparator of a BUFF_OPMODE_R_PRIORITY buffer (required before pushing)
+ * @note  Push and pop are O(log n). Items with the same priority are not popped in insertion order.
+ *        Reserve, commit and span operations are not available on this mode, and buff_peek index zero is
+ *        the next item while the rest follow the heap order
+ * @param ctrl      Buffer controller
+ * @param compare   Item comparator
+ * @return Error code
+ */
+uint32_t buff_set_priority(t_buff* ctrl, t_buff_compare compare);
+
+/**
+ * @brief Set the watermark callbacks for the buffer (batch consumer wake-ups)
+ * @note  on_high fires once when the occupancy rises to high, on_low fires once when it falls back to low.
+ *        Callbacks run on the context that crossed the threshold, after the lock is released
+ * @param ctrl      Buffer controller
+ * @param high      High watermark (# items, 1 to buff_size)
+ * @param low       Low watermark (# items, below high)
+ * @param on_high   High watermark callback (may be NULL)
+ * @param on_low    Low watermark callback (may be NULL)
+ * @param object    Watermark object (passed to the callbacks)
+ * @return Error code
+ */
+uint32_t buff_set_watermarks(t_buff* ctrl, size_t high, size_t low, t_buff_watermark on_high, t_buff_watermark on_low, void* object);
+
+/**
+ * @brief Idle flush: calls the high watermark callback if there are pending items, even below the high watermark
+ * @note  Call it from an idle hook or timer so a partial batch is not left waiting for more data
+ * @param ctrl      Buffer controller
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if there is nothing to flush)
+ */
+uint32_t buff_flush(t_buff* ctrl);
+
 /**
  * @brief Clears the buffer
+ * @note  On BUFF_OPMODE_SPSC the producer and consumer must be stopped while clearing
  * @param ctrl      Buffer controller
  * @return Error code
  */
@@ -140,6 +553,17 @@ uint32_t buff_clear(t_buff* ctrl);
  */
 uint32_t buff_push(t_buff* ctrl, const void* item);
 
+/**
+ * @brief Pushes an item into the buffer, waiting for free space if the buffer is full
+ * @note  Requires buff_set_notify with a space event. On overflow mode it never waits.
+ *        The timeout is a deadline: it holds even if other producers keep taking the freed space
+ * @param ctrl      Buffer controller
+ * @param item      Incoming item
+ * @param timeout   Timeout (ms). Zero polls, RTOS_WAIT_FOREVER blocks without timeout
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW on timeout)
+ */
+uint32_t buff_push_wait(t_buff* ctrl, const void* item, uint32_t timeout);
+
 /**
  * @brief Pushes several items into the buffer
  * @note  Depending if the buffer is on overflow mode, the oldest item may be overwritten (an error is returned otherwise)
@@ -152,6 +576,37 @@ uint32_t buff_push(t_buff* ctrl, const void* item);
  */
 uint32_t buff_push_chunk(t_buff* ctrl, const void* buff, size_t size, size_t* pushed);
 
+/**
+ * @brief Pushes the items of several segments into the buffer (scatter-gather, no staging copy)
+ * @note  The segments are transferred under a single lock acquisition, all or nothing: if they don't fit nothing is
+ *        pushed and an error is returned. On overflow mode the oldest items are overwritten to make room
+ * @param ctrl      Buffer controller
+ * @param iov       Incoming segments (buff: first item, size: number of items)
+ * @param iov_count Number of segments
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if the items don't fit)
+ */
+uint32_t buff_push_iov(t_buff* ctrl, const t_buff_span* iov, size_t iov_count);
+
+/**
+ * @brief Reserves a contiguous region of free slots to be written in place (zero-copy push)
+ * @note  Only available on FIFO mode. Only one producer may hold a reservation at a time.
+ *        On overflow mode the oldest items overlapping the reserved region are dropped right away,
+ *        otherwise the region is limited to the free slots. The region never crosses the wrap point
+ * @param ctrl      Buffer controller
+ * @param buff      Returns the start of the reserved region
+ * @param size      In: number of items requested. Out: number of items reserved
+ * @return Error code
+ */
+uint32_t buff_reserve(t_buff* ctrl, void** buff, size_t* size);
+
+/**
+ * @brief Commits items written in a region obtained with buff_reserve
+ * @param ctrl      Buffer controller
+ * @param size      Number of items written (up to the reserved size)
+ * @return Error code
+ */
+uint32_t buff_commit(t_buff* ctrl, size_t size);
+
 /**
  * @brief Pops an item from the buffer
  * @note  Depending on the read mode (FIFO/LIFO), the oldest or newest item is popped
@@ -161,6 +616,17 @@ uint32_t buff_push_chunk(t_buff* ctrl, const void* buff, size_t size, size_t* pu
  */
 uint32_t buff_pop(t_buff* ctrl, void* item);
 
+/**
+ * @brief Pops an item from the buffer, waiting for data if the buffer is empty
+ * @note  Requires buff_set_notify with a data event.
+ *        The timeout is a deadline: it holds even if other consumers keep taking the new data
+ * @param ctrl      Buffer controller
+ * @param item      Receiving item
+ * @param timeout   Timeout (ms). Zero polls, RTOS_WAIT_FOREVER blocks without timeout
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY on timeout)
+ */
+uint32_t buff_pop_wait(t_buff* ctrl, void* item, uint32_t timeout);
+
 /**
  * @brief Pops several items from the buffer
  * @note  Depending on the read mode (FIFO/LIFO), the oldest or newest item is popped
@@ -172,6 +638,17 @@ uint32_t buff_pop(t_buff* ctrl, void* item);
  */
 uint32_t buff_pop_chunk(t_buff* ctrl, void* buff, size_t size, size_t* popped);
 
+/**
+ * @brief Pops items from the buffer into several segments (scatter-gather)
+ * @note  The segments are filled in order under a single lock acquisition until the buffer is empty
+ * @param ctrl      Buffer controller
+ * @param iov       Receiving segments (buff: first item, size: number of items)
+ * @param iov_count Number of segments
+ * @param popped    Number of items actually popped
+ * @return Error code
+ */
+uint32_t buff_pop_iov(t_buff* ctrl, const t_buff_span* iov, size_t iov_count, size_t* popped);
+
 /**
  * @brief Reads an item from the buffer without popping it
  * @note  Depending on the read mode (FIFO/LIFO), the oldest or newest item is read
@@ -182,6 +659,113 @@ uint32_t buff_pop_chunk(t_buff* ctrl, void* buff, size_t size, size_t* popped);
  */
 uint32_t buff_peek(t_buff* ctrl, void* item, size_t index);
 
+/**
+ * @brief Reads several items from the buffer without popping them (one lock acquisition)
+ * @note  Items are copied in read order (FIFO/LIFO) starting at the given index, as buff_peek would
+ * @param ctrl      Buffer controller
+ * @param buff      Receiving array of items
+ * @param start     Index of the first item
+ * @param size      Maximum number of items to read
+ * @param peeked    Number of items actually read (optional)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_INDEX if start is past the stored items)
+ */
+uint32_t buff_peek_chunk(t_buff* ctrl, void* buff, size_t start, size_t size, size_t* peeked);
+
+/**
+ * @brief Starts walking the stored items in read order (FIFO/LIFO). The buffer stays locked until buff_iter_end
+ * @note  Items are accessed in place. Only the items stored when the walk starts are visited.
+ *        Other functions of the same buffer must not be called before buff_iter_end (unless the walk runs
+ *        inside a buff_begin/buff_end transaction). On BUFF_OPMODE_SPSC only the consumer may iterate
+ * @param ctrl      Buffer controller
+ * @param iter      Iterator
+ * @return Error code
+ */
+uint32_t buff_iter_begin(t_buff* ctrl, t_buff_iter* iter);
+
+/**
+ * @brief Gets the next item of a walk
+ * @param iter      Iterator
+ * @return Item address (NULL once every item was visited)
+ */
+const void* buff_iter_next(t_buff_iter* iter);
+
+/**
+ * @brief Gets the next items of a walk as a contiguous region of the items array (at most two per walk)
+ * @note  On LIFO mode regions come newest first, but the items inside a region are stored oldest first
+ * @param iter      Iterator
+ * @param span      Returns the region
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY once every item was visited)
+ */
+uint32_t buff_iter_next_span(t_buff_iter* iter, t_buff_span* span);
+
+/**
+ * @brief Ends a walk and releases the buffer
+ * @param iter      Iterator
+ * @return Error code
+ */
+uint32_t buff_iter_end(t_buff_iter* iter);
+
+/**
+ * @brief Gets the stored items as contiguous regions of the items array, without copying them (zero-copy read)
+ * @note  Only available on FIFO mode. The first span starts at the oldest item, the second one (if any)
+ *        holds the items after the wrap point. Spans remain valid until the items are consumed, unless
+ *        the buffer is on overflow mode and a producer overwrites them
+ * @param ctrl      Buffer controller
+ * @param first     Returns the region starting at the oldest item
+ * @param second    Returns the region after the wrap point (optional, size zero if not used)
+ * @return Error code
+ */
+uint32_t buff_peek_span(t_buff* ctrl, t_buff_span* first, t_buff_span* second);
+
+/**
+ * @brief Drops the oldest items after processing them in place (see buff_peek_span)
+ * @note  Only available on FIFO mode
+ * @param ctrl      Buffer controller
+ * @param size      Number of items to drop (up to the number of items stored)
+ * @return Error code
+ */
+uint32_t buff_consume(t_buff* ctrl, size_t size);
+
+/**
+ * @brief Publishes the items written by a circular DMA (BUFF_OPMODE_DMA) since the last call
+ * @note  The DMA must write the items array in circular mode, starting at the first item once the buffer is
+ *        initialized (buff_init with clear set). Call it from the half/full transfer and idle interrupts (at least twice per lap) or before
+ *        reading. Items are read in place (buff_peek_span/buff_consume, iterator) or popped as usual.
+ *        At most buff_size - 1 items are kept: once the DMA reaches the oldest item it is reported as overrun
+ *        and the items it is about to overwrite are dropped.
+ *        If several contexts call it, the counter must be read while holding the buffer (buff_begin/buff_end),
+ *        otherwise a stale count could move the tail backwards
+ * @param ctrl      Buffer controller
+ * @param remaining DMA remaining transfer count (# items, 1 to buff_size, e.g. the NDTR/CNDTR register)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if the DMA overran the consumer)
+ */
+uint32_t buff_sync_producer(t_buff* ctrl, size_t remaining);
+
+#if BUFF_ENABLE_STATS == 1U
+/**
+ * @brief Gets a snapshot of the buffer runtime statistics
+ * @note  On BUFF_OPMODE_SPSC the snapshot is not atomic: counters may be updated while copying
+ * @param ctrl      Buffer controller
+ * @param stats     Receiving statistics
+ * @return Error code
+ */
+uint32_t buff_get_stats(t_buff* ctrl, t_buff_stats* stats);
+
+/**
+ * @brief Resets the buffer runtime statistics (the peak restarts from the current occupancy)
+ * @param ctrl      Buffer controller
+ * @return Error code
+ */
+uint32_t buff_reset_stats(t_buff* ctrl);
+
+/**
+ * @brief Clock used to measure the lock time
+ * @note  Weak implementation: microseconds on HOST, zero otherwise. Override it with a cycle counter or timer
+ * @return Timestamp (ticks)
+ */
+uint32_t buff_stats_clock(void);
+#endif
+
 /**
  * @brief Returns if the buffer is full
  * @param ctrl      Buffer controller
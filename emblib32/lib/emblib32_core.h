@@ -93,6 +93,52 @@ extern "C" {
   #define ARRAY_SIZE(a)  (sizeof(a) / sizeof(a[0]))
 #endif
 
+/** Atomic load (relaxed ordering, C11 memory model) */
+#ifndef ATOMIC_LOAD_RELAXED
+  #define ATOMIC_LOAD_RELAXED(ptr)        __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#endif
+
+/** Atomic load (acquire ordering, C11 memory model) */
+#ifndef ATOMIC_LOAD_ACQUIRE
+  #define ATOMIC_LOAD_ACQUIRE(ptr)        __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#endif
+
+/** Atomic store (release ordering, C11 memory model) */
+#ifndef ATOMIC_STORE_RELEASE
+  #define ATOMIC_STORE_RELEASE(ptr, val)  __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#endif
+
+/** Atomic weak compare-and-swap (relaxed ordering, C11 memory model). On failure expected is updated */
+#ifndef ATOMIC_CAS_RELAXED
+  #define ATOMIC_CAS_RELAXED(ptr, expected, val) \
+    __atomic_compare_exchange_n((ptr), (expected), (val), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif
+
+/** Atomic fetch-and-add (relaxed ordering, C11 memory model). Returns the previous value */
+#ifndef ATOMIC_FETCH_ADD_RELAXED
+  #define ATOMIC_FETCH_ADD_RELAXED(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+#endif
+
+/** Atomic exchange (acquire-release ordering, C11 memory model). Returns the previous value */
+#ifndef ATOMIC_EXCHANGE_ACQ_REL
+  #define ATOMIC_EXCHANGE_ACQ_REL(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+#endif
+
+/** Acquire fence (C11 memory model) */
+#ifndef ATOMIC_FENCE_ACQUIRE
+  #define ATOMIC_FENCE_ACQUIRE()          __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+/** Release fence (C11 memory model) */
+#ifndef ATOMIC_FENCE_RELEASE
+  #define ATOMIC_FENCE_RELEASE()          __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+/** Full fence (sequentially consistent, C11 memory model) */
+#ifndef ATOMIC_FENCE_SEQ_CST
+  #define ATOMIC_FENCE_SEQ_CST()          __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_Macros -->
 *//*-----------------------------------------------------------------------*//**
@@ -0,0 +1,256 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_latest.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free latest-value exchange (triple buffer and seqlock).
+ * @note    Writers never block, readers always get a consistent snapshot
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "emblib32_latest.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Latest
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define TRIPLE_INDEX_MASK   0x03U     /*!< Triple buffer: middle copy index */
+#define TRIPLE_FRESH        0x04U     /*!< Triple buffer: middle copy not read yet */
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static uint8_t* _latest_copy(uint8_t* buff, size_t item_size, uint32_t index);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t triple_init(t_triple* ctrl, void* buff, size_t item_size)
+{
+  /* Sanity check */
+  if (!ctrl || !buff || (item_size == 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize triple buffer */
+  ctrl->buff      = (uint8_t*)buff;
+  ctrl->item_size = item_size;
+  ctrl->back      = 0;
+  ctrl->middle    = 1;
+  ctrl->front     = 2;
+  ctrl->valid     = false;
+  return EMBLIB32_OK;
+}
+
+uint32_t triple_write(t_triple* ctrl, const void* item)
+{
+  uint32_t middle;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Fill the back copy and make it the middle one */
+  memcpy(_latest_copy(ctrl->buff, ctrl->item_size, ctrl->back), item, ctrl->item_size);
+  middle     = ATOMIC_EXCHANGE_ACQ_REL(&ctrl->middle, (ctrl->back | TRIPLE_FRESH));
+  ctrl->back = middle & TRIPLE_INDEX_MASK;
+  return EMBLIB32_OK;
+}
+
+uint32_t triple_read(t_triple* ctrl, void* item)
+{
+  uint32_t middle;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Take the middle copy only if it is newer than the front one */
+  if (ATOMIC_LOAD_RELAXED(&ctrl->middle) & TRIPLE_FRESH)
+  {
+    middle      = ATOMIC_EXCHANGE_ACQ_REL(&ctrl->middle, ctrl->front);
+    ctrl->front = middle & TRIPLE_INDEX_MASK;
+    ctrl->valid = true;
+  }
+  if (!ctrl->valid)
+  {
+    memset(item, 0x00, ctrl->item_size);
+    return EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+  memcpy(item, _latest_copy(ctrl->buff, ctrl->item_size, ctrl->front), ctrl->item_size);
+  return EMBLIB32_OK;
+}
+
+bool triple_is_fresh(const t_triple* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+
+  return (ATOMIC_LOAD_ACQUIRE(&ctrl->middle) & TRIPLE_FRESH) != 0;
+}
+
+uint32_t seqlock_init(t_seqlock* ctrl, void* buff, size_t item_size)
+{
+  /* Sanity check */
+  if (!ctrl || !buff || (item_size == 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize seqlock */
+  ctrl->buff      = (uint8_t*)buff;
+  ctrl->item_size = item_size;
+  ctrl->seq       = 0;
+  return EMBLIB32_OK;
+}
+
+uint32_t seqlock_write(t_seqlock* ctrl, const void* item)
+{
+  uint32_t seq;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Odd: readers move to copy 1 while copy 0 is updated */
+  seq = ATOMIC_LOAD_RELAXED(&ctrl->seq);
+  ATOMIC_STORE_RELEASE(&ctrl->seq, (seq + 1));
+  ATOMIC_FENCE_RELEASE();
+  memcpy(_latest_copy(ctrl->buff, ctrl->item_size, 0), item, ctrl->item_size);
+
+  /* Even: readers move back to copy 0 while copy 1 is updated */
+  ATOMIC_STORE_RELEASE(&ctrl->seq, (seq + 2));
+  ATOMIC_FENCE_RELEASE();
+  memcpy(_latest_copy(ctrl->buff, ctrl->item_size, 1), item, ctrl->item_size);
+  return EMBLIB32_OK;
+}
+
+uint32_t seqlock_read(const t_seqlock* ctrl, void* item, uint32_t* version)
+{
+  uint32_t seq;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Copy the stable copy, retry if the writer switched copies meanwhile */
+  do
+  {
+    seq = ATOMIC_LOAD_ACQUIRE(&ctrl->seq);
+    if (seq < 2)
+    {
+      memset(item, 0x00, ctrl->item_size);
+      return EMBLIB32_ERROR_BUFFER_EMPTY;
+    }
+    memcpy(item, _latest_copy(ctrl->buff, ctrl->item_size, (seq & 1)), ctrl->item_size);
+    ATOMIC_FENCE_ACQUIRE();
+  } while (ATOMIC_LOAD_RELAXED(&ctrl->seq) != seq);
+
+  if (version)
+  {
+    *version = seq / 2;
+  }
+  return EMBLIB32_OK;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Gets a copy address
+ * @param buff      Array of copies
+ * @param item_size Item size (bytes)
+ * @param index     Copy index
+ * @return Copy address
+ */
+static uint8_t* _latest_copy(uint8_t* buff, size_t item_size, uint32_t index)
+{
+  return buff + (index * item_size);
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Latest -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,174 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_latest.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free latest-value exchange (triple buffer and seqlock).
+ * @note    Writers never block, readers always get a consistent snapshot
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_LATEST_H_
+#define _EMBLIB32_LATEST_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Latest
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Size of the storage required by a triple buffer (bytes) */
+#define TRIPLE_STORAGE_SIZE(item_size)    (3U * (item_size))
+
+/** Size of the storage required by a seqlock (bytes) */
+#define SEQLOCK_STORAGE_SIZE(item_size)   (2U * (item_size))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * Triple buffer controller structure (one writer, one reader).
+ * The writer fills the back copy and swaps it with the middle one, the reader swaps the middle copy with the
+ * front one only if it is newer. Neither side ever touches the copy the other one owns.
+ */
+typedef struct
+{
+  uint8_t*          buff;       /*!< Array of copies (3) */
+  size_t            item_size;  /*!< Item size (bytes) */
+  volatile uint32_t middle;     /*!< Middle copy index and fresh flag (shared) */
+  uint32_t          back BUFF_CACHE_ALIGNED;  /*!< Copy owned by the writer */
+  uint32_t          front BUFF_CACHE_ALIGNED; /*!< Copy owned by the reader */
+  bool              valid;      /*!< The reader got a value at least once */
+} t_triple;
+
+/**
+ * Seqlock controller structure (one writer, several readers).
+ * Two copies are kept (latch): while one is being written readers use the other one, so a reader that preempts
+ * the writer still completes. The sequence parity selects the copy to read.
+ */
+typedef struct
+{
+  uint8_t*          buff;       /*!< Array of copies (2) */
+  size_t            item_size;  /*!< Item size (bytes) */
+  volatile uint32_t seq;        /*!< Sequence (two steps per write) */
+} t_seqlock;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a triple buffer instance
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl      Triple buffer controller
+ * @param buff      Array of copies (TRIPLE_STORAGE_SIZE(item_size) bytes)
+ * @param item_size Item size (bytes)
+ * @return Error code
+ */
+uint32_t triple_init(t_triple* ctrl, void* buff, size_t item_size);
+
+/**
+ * @brief Publishes a new value (wait-free, writer context only)
+ * @param ctrl      Triple buffer controller
+ * @param item      Incoming item
+ * @return Error code
+ */
+uint32_t triple_write(t_triple* ctrl, const void* item);
+
+/**
+ * @brief Gets the latest value (wait-free, reader context only)
+ * @note  The same value is returned until a new one is published
+ * @param ctrl      Triple buffer controller
+ * @param item      Receiving item
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if nothing was published yet)
+ */
+uint32_t triple_read(t_triple* ctrl, void* item);
+
+/**
+ * @brief Returns if a value was published since the last read
+ * @param ctrl      Triple buffer controller
+ * @return True if there is a new value
+ */
+bool triple_is_fresh(const t_triple* ctrl);
+
+/**
+ * @brief Initializes a seqlock instance
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl      Seqlock controller
+ * @param buff      Array of copies (SEQLOCK_STORAGE_SIZE(item_size) bytes)
+ * @param item_size Item size (bytes)
+ * @return Error code
+ */
+uint32_t seqlock_init(t_seqlock* ctrl, void* buff, size_t item_size);
+
+/**
+ * @brief Publishes a new value (wait-free)
+ * @note  Only one context may write. Several writers must be serialized by the caller
+ * @param ctrl      Seqlock controller
+ * @param item      Incoming item
+ * @return Error code
+ */
+uint32_t seqlock_write(t_seqlock* ctrl, const void* item);
+
+/**
+ * @brief Gets the latest value (lock-free, any number of readers)
+ * @note  The copy is retried only if the writer published a new value meanwhile
+ * @param ctrl      Seqlock controller
+ * @param item      Receiving item
+ * @param version   Returns the value version (incremented on every write, may be NULL)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if nothing was published yet)
+ */
+uint32_t seqlock_read(const t_seqlock* ctrl, void* item, uint32_t* version);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Latest -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_LATEST_H_ */
@@ -0,0 +1,307 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_pool.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Fixed-size block pool with pointer passing over buffers.
+ * @note    Large items travel as a single pointer: the block is lent to the consumer, who returns it to the pool
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "emblib32_pool.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Pool
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/* Block owners (header tags, POOL_DEBUG) */
+#define POOL_OWNER_POOL                 0x46524545U  /*!< "FREE": on the free list */
+#define POOL_OWNER_USER                 0x55534552U  /*!< "USER": allocated or received by a context */
+#define POOL_OWNER_QUEUE                0x51554555U  /*!< "QUEU": sent, waiting on a queue */
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static bool _pool_contains(const t_pool* ctrl, const void* block);
+static bool _pool_transfer(void* block, size_t from, size_t to);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t pool_init(t_pool* ctrl, void* blocks, size_t block_count, size_t block_size, t_buff* free)
+{
+  uint8_t* block;
+
+  /* Sanity check */
+  if (!ctrl || !blocks || (block_count == 0) || (block_size == 0) || !free || !free->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((free->item_size != sizeof(void*)) || (free->buff_size < block_count) ||
+      !(free->mode & BUFF_OPMODE_R_FIFO) || (free->mode & (BUFF_OPMODE_W_OVERFLOW | BUFF_OPMODE_DMA)))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize pool */
+  ctrl->blocks      = (uint8_t*)blocks;
+  ctrl->block_size  = block_size;
+  ctrl->block_count = block_count;
+  ctrl->stride      = POOL_BLOCK_STRIDE(block_size);
+  ctrl->free        = free;
+
+  /* Every block starts on the free list */
+  buff_clear(free);
+  for (size_t idx = 0; idx < block_count; idx++)
+  {
+    block = ctrl->blocks + (idx * ctrl->stride) + POOL_HEADER_SIZE;
+#if POOL_DEBUG == 1U
+    ((size_t*)block)[-1] = POOL_OWNER_POOL;
+#endif
+    buff_push(free, &block);
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t pool_deinit(t_pool* ctrl, size_t* leaked)
+{
+  size_t used;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->free)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+#if POOL_DEBUG == 1U
+  /* Count the blocks the pool doesn't own */
+  used = 0;
+  for (size_t idx = 0; idx < ctrl->block_count; idx++)
+  {
+    if (((size_t*)(ctrl->blocks + (idx * ctrl->stride)))[0] != POOL_OWNER_POOL)
+    {
+      used++;
+    }
+  }
+#else
+  used = pool_get_used(ctrl);
+#endif
+  if (leaked)
+  {
+    *leaked = used;
+  }
+  ctrl->free = NULL;
+  return (used == 0)? EMBLIB32_OK : EMBLIB32_ERROR_POOL_LEAK;
+}
+
+uint32_t pool_alloc(t_pool* ctrl, void** block)
+{
+  /* Sanity check */
+  if (!ctrl || !ctrl->free || !block)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  if (buff_pop(ctrl->free, block) != EMBLIB32_OK)
+  {
+    *block = NULL;
+    return EMBLIB32_ERROR_POOL_EMPTY;
+  }
+  _pool_transfer(*block, POOL_OWNER_POOL, POOL_OWNER_USER);
+  return EMBLIB32_OK;
+}
+
+uint32_t pool_free(t_pool* ctrl, void* block)
+{
+  /* Sanity check */
+  if (!ctrl || !ctrl->free || !block)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!_pool_contains(ctrl, block) || !_pool_transfer(block, POOL_OWNER_USER, POOL_OWNER_POOL))
+  {
+    return EMBLIB32_ERROR_POOL_OWNERSHIP;
+  }
+
+  /* The free list fits every block: it can only be full after an undetected double free (no POOL_DEBUG) */
+  return buff_push(ctrl->free, &block);
+}
+
+uint32_t pool_send(t_pool* ctrl, t_buff* queue, void* block)
+{
+  uint32_t error;
+
+  /* Sanity check */
+  if (!ctrl || !queue || (queue->item_size != sizeof(void*)) || !block)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!_pool_contains(ctrl, block) || !_pool_transfer(block, POOL_OWNER_USER, POOL_OWNER_QUEUE))
+  {
+    return EMBLIB32_ERROR_POOL_OWNERSHIP;
+  }
+
+  /* The block must be tagged before the consumer can see it */
+  error = buff_push(queue, &block);
+  if (error != EMBLIB32_OK)
+  {
+    _pool_transfer(block, POOL_OWNER_QUEUE, POOL_OWNER_USER);
+  }
+  return error;
+}
+
+uint32_t pool_receive(t_pool* ctrl, t_buff* queue, void** block)
+{
+  uint32_t error;
+
+  /* Sanity check */
+  if (!ctrl || !queue || (queue->item_size != sizeof(void*)) || !block)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  error = buff_pop(queue, block);
+  if (error != EMBLIB32_OK)
+  {
+    return error;
+  }
+  if (!_pool_contains(ctrl, *block) || !_pool_transfer(*block, POOL_OWNER_QUEUE, POOL_OWNER_USER))
+  {
+    /* Not sent with pool_send: still handed to the caller (see the header for who owns it) */
+    return EMBLIB32_ERROR_POOL_OWNERSHIP;
+  }
+  return EMBLIB32_OK;
+}
+
+size_t pool_get_used(t_pool* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl || !ctrl->free)
+  {
+    return 0;
+  }
+
+  return ctrl->block_count - buff_get_count(ctrl->free);
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks if a pointer is the start of one of the pool blocks
+ * @param ctrl  Block pool controller
+ * @param block Block pointer
+ * @return True if the block belongs to the pool
+ */
+static bool _pool_contains(const t_pool* ctrl, const void* block)
+{
+  const uint8_t* base = ctrl->blocks + POOL_HEADER_SIZE;
+  const uint8_t* ptr  = (const uint8_t*)block;
+
+  if ((ptr < base) || (ptr >= (base + (ctrl->block_count * ctrl->stride))))
+  {
+    return false;
+  }
+  return (((size_t)(ptr - base) % ctrl->stride) == 0);
+}
+
+/**
+ * @brief Moves a block from one owner to another (POOL_DEBUG)
+ * @note  Only the current owner may call it, so the tag doesn't need atomic updates
+ * @param block Block pointer
+ * @param from  Expected owner
+ * @param to    New owner
+ * @return True if the block was owned by from (always true without POOL_DEBUG)
+ */
+static bool _pool_transfer(void* block, size_t from, size_t to)
+{
+#if POOL_DEBUG == 1U
+  size_t* owner = &((size_t*)block)[-1];
+
+  if (*owner != from)
+  {
+    return false;
+  }
+  *owner = to;
+#else
+  UNUSED(block);
+  UNUSED(from);
+  UNUSED(to);
+#endif
+  return true;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Pool -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,196 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_pool.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Fixed-size block pool with pointer passing over buffers.
+ * @note    Large items travel as a single pointer: the block is lent to the consumer, who returns it to the pool
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_POOL_H_
+#define _EMBLIB32_POOL_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Pool
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/* Error codes */
+#define EMBLIB32_ERROR_POOL_EMPTY       0x31U    /*!< No free block left */
+#define EMBLIB32_ERROR_POOL_OWNERSHIP   0x32U    /*!< The block is not owned by the caller (foreign, free or queued) */
+#define EMBLIB32_ERROR_POOL_LEAK        0x33U    /*!< Some blocks were not returned to the pool */
+
+/**
+ * Block ownership tracking (one header word per block). Double frees, freeing a queued block and pointers pushed
+ * behind the pool back are only detected with it: without it a double free puts the block twice on the free list
+ */
+#ifndef POOL_DEBUG
+  #if defined(DEBUG)
+    #define POOL_DEBUG                  1U
+  #else
+    #define POOL_DEBUG                  0U
+  #endif
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Size of the block header (ownership state, POOL_DEBUG only) */
+#if POOL_DEBUG == 1U
+  #define POOL_HEADER_SIZE              sizeof(size_t)
+#else
+  #define POOL_HEADER_SIZE              0U
+#endif
+
+/** Size of a pool block: header + block (padded to keep the blocks size_t aligned) */
+#define POOL_BLOCK_STRIDE(block_size) \
+  (POOL_HEADER_SIZE + ((((block_size) + sizeof(size_t) - 1U) / sizeof(size_t)) * sizeof(size_t)))
+
+/** Size of the storage required by a pool (bytes) */
+#define POOL_STORAGE_SIZE(block_count, block_size) \
+  ((block_count) * POOL_BLOCK_STRIDE(block_size))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * Block pool controller structure.
+ * Every block has a single owner at a time: the pool (free), the context that allocated or received it, or the
+ * queue it was sent to. pool_alloc and pool_receive hand the block to the caller, pool_send hands it to the queue
+ * and pool_free gives it back to the pool. Only the block pointer is copied on every step.
+ */
+typedef struct
+{
+  uint8_t*        blocks;     /*!< Array of blocks */
+  size_t          block_size; /*!< Block size (bytes) */
+  size_t          block_count;/*!< Number of blocks */
+  size_t          stride;     /*!< Distance between blocks (bytes) */
+  t_buff*         free;       /*!< Free blocks (pointers) */
+} t_pool;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a block pool instance
+ * @note  This function is thread unsafe. Use with care
+ *        The free list is cleared and filled with every block. Its mode sets who may allocate and free: with
+ *        BUFF_OPMODE_SPSC one context may allocate and another one may free without lock, otherwise use its lock
+ * @param ctrl        Block pool controller
+ * @param blocks      Array of blocks (POOL_STORAGE_SIZE(block_count, block_size) bytes, size_t aligned)
+ * @param block_count Number of blocks
+ * @param block_size  Block size (bytes)
+ * @param free        Free list (FIFO, no overflow, sizeof(void*) items, block_count items at least)
+ * @return Error code
+ */
+uint32_t pool_init(t_pool* ctrl, void* blocks, size_t block_count, size_t block_size, t_buff* free);
+
+/**
+ * @brief Releases a block pool instance
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl        Block pool controller
+ * @param leaked      Returns the number of blocks not returned to the pool (may be NULL)
+ * @return Error code (EMBLIB32_ERROR_POOL_LEAK if some blocks are still allocated or queued)
+ */
+uint32_t pool_deinit(t_pool* ctrl, size_t* leaked);
+
+/**
+ * @brief Takes a free block. The caller owns it until it is sent or freed
+ * @param ctrl        Block pool controller
+ * @param block       Returns the block (NULL on error)
+ * @return Error code (EMBLIB32_ERROR_POOL_EMPTY if there are no free blocks)
+ */
+uint32_t pool_alloc(t_pool* ctrl, void** block);
+
+/**
+ * @brief Returns a block to the pool. The caller gives up its ownership
+ * @note  Foreign and misaligned pointers are always rejected. Blocks already free or still queued are only
+ *        rejected on POOL_DEBUG: otherwise freeing a block twice corrupts the free list (the block is handed out twice)
+ * @param ctrl        Block pool controller
+ * @param block       Block owned by the caller
+ * @return Error code (EMBLIB32_ERROR_POOL_OWNERSHIP if the caller doesn't own the block)
+ */
+uint32_t pool_free(t_pool* ctrl, void* block);
+
+/**
+ * @brief Sends a block pointer through a queue. The ownership moves to the queue
+ * @note  If the push fails the caller keeps the block
+ * @param ctrl        Block pool controller
+ * @param queue       Queue (sizeof(void*) items)
+ * @param block       Block owned by the caller
+ * @return Error code (queue push error or EMBLIB32_ERROR_POOL_OWNERSHIP)
+ */
+uint32_t pool_send(t_pool* ctrl, t_buff* queue, void* block);
+
+/**
+ * @brief Receives a block pointer from a queue. The caller owns the block until it is sent again or freed
+ * @note  On EMBLIB32_ERROR_POOL_OWNERSHIP the pointer was already removed from the queue and is still returned.
+ *        If it is a pool block pushed without pool_send (POOL_DEBUG only) the caller now owns it and must give it
+ *        back with pool_free. A foreign pointer, or a block that was already free (pool_free rejects it), must
+ *        not be freed
+ * @param ctrl        Block pool controller
+ * @param queue       Queue (sizeof(void*) items)
+ * @param block       Returns the block (NULL if the queue is empty)
+ * @return Error code (queue pop error or EMBLIB32_ERROR_POOL_OWNERSHIP)
+ */
+uint32_t pool_receive(t_pool* ctrl, t_buff* queue, void** block);
+
+/**
+ * @brief Get the number of blocks out of the pool (allocated or queued)
+ * @param ctrl        Block pool controller
+ * @return Blocks in use (# blocks)
+ */
+size_t pool_get_used(t_pool* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Pool -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_POOL_H_ */
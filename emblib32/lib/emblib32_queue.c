@@ -0,0 +1,269 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_queue.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free bounded multi-producer/multi-consumer queue.
+ * @note    Per-slot sequence numbers (D. Vyukov bounded MPMC queue)
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "emblib32_queue.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Queue
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Get the slot sequence number */
+#define QUEUE_SEQ(slot)     ((volatile size_t*)(slot))
+
+/** Get the slot item */
+#define QUEUE_ITEM(slot)    ((slot) + sizeof(size_t))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static uint8_t* _queue_slot(const t_queue* ctrl, size_t pos);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t queue_init(t_queue* ctrl, void* buff, size_t buff_size, size_t item_size)
+{
+  /* Sanity check */
+  if (!ctrl || !buff || (item_size == 0) || (buff_size < 2) || ((buff_size & (buff_size - 1)) != 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize queue */
+  ctrl->buff      = (uint8_t*)buff;
+  ctrl->buff_size = buff_size;
+  ctrl->item_size = item_size;
+  ctrl->slot_size = QUEUE_SLOT_SIZE(item_size);
+  ctrl->mask      = buff_size - 1;
+  ctrl->head      = 0;
+  ctrl->tail      = 0;
+
+  /* Each slot is initially free for the lap starting at its own position */
+  for (size_t pos = 0; pos < buff_size; pos++)
+  {
+    *QUEUE_SEQ(_queue_slot(ctrl, pos)) = pos;
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t queue_push(t_queue* ctrl, const void* item)
+{
+  uint8_t*  slot;
+  size_t    pos;
+  ptrdiff_t diff;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Claim a slot: free when its sequence matches the position */
+  pos = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  for (;;)
+  {
+    slot = _queue_slot(ctrl, pos);
+    diff = (ptrdiff_t)(ATOMIC_LOAD_ACQUIRE(QUEUE_SEQ(slot)) - pos);
+    if (diff == 0)
+    {
+      if (ATOMIC_CAS_RELAXED(&ctrl->tail, &pos, (pos + 1)))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      /* Slot still holds an item from the previous lap */
+      return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+    }
+    else
+    {
+      /* Another producer claimed it */
+      pos = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+    }
+  }
+
+  /* Fill the slot and hand it over to the consumers */
+  memcpy(QUEUE_ITEM(slot), item, ctrl->item_size);
+  ATOMIC_STORE_RELEASE(QUEUE_SEQ(slot), (pos + 1));
+  return EMBLIB32_OK;
+}
+
+uint32_t queue_pop(t_queue* ctrl, void* item)
+{
+  uint8_t*  slot;
+  size_t    pos;
+  ptrdiff_t diff;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Claim a slot: ready when its sequence is one past the position */
+  pos = ATOMIC_LOAD_RELAXED(&ctrl->head);
+  for (;;)
+  {
+    slot = _queue_slot(ctrl, pos);
+    diff = (ptrdiff_t)(ATOMIC_LOAD_ACQUIRE(QUEUE_SEQ(slot)) - (pos + 1));
+    if (diff == 0)
+    {
+      if (ATOMIC_CAS_RELAXED(&ctrl->head, &pos, (pos + 1)))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      /* Slot not written yet */
+      memset(item, 0x00, ctrl->item_size);
+      return EMBLIB32_ERROR_BUFFER_EMPTY;
+    }
+    else
+    {
+      /* Another consumer claimed it */
+      pos = ATOMIC_LOAD_RELAXED(&ctrl->head);
+    }
+  }
+
+  /* Read the slot and free it for the next lap */
+  memcpy(item, QUEUE_ITEM(slot), ctrl->item_size);
+  ATOMIC_STORE_RELEASE(QUEUE_SEQ(slot), (pos + ctrl->buff_size));
+  return EMBLIB32_OK;
+}
+
+bool queue_is_empty(const t_queue* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return false;
+  }
+
+  return queue_get_count(ctrl) == 0;
+}
+
+size_t queue_get_size(const t_queue* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  return ctrl->buff_size;
+}
+
+size_t queue_get_count(const t_queue* ctrl)
+{
+  size_t head;
+  size_t tail;
+
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  /* Positions claimed but not completed yet are counted as stored */
+  head = ATOMIC_LOAD_ACQUIRE(&ctrl->head);
+  tail = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+  return ((ptrdiff_t)(tail - head) > 0)? MIN((tail - head), ctrl->buff_size) : 0;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Gets the slot for a given position
+ * @param ctrl Queue controller
+ * @param pos  Position (free running)
+ * @return Slot address
+ */
+static uint8_t* _queue_slot(const t_queue* ctrl, size_t pos)
+{
+  return ctrl->buff + ((pos & ctrl->mask) * ctrl->slot_size);
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Queue -->
+*//*--------------------------------------------------------------------------*/
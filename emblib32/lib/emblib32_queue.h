@@ -0,0 +1,152 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_queue.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free bounded multi-producer/multi-consumer queue.
+ * @note    Per-slot sequence numbers (D. Vyukov bounded MPMC queue)
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_QUEUE_H_
+#define _EMBLIB32_QUEUE_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Queue
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Size of a queue slot: sequence number + item (padded to keep the sequence numbers aligned) */
+#define QUEUE_SLOT_SIZE(item_size) \
+  (sizeof(size_t) + ((((item_size) + sizeof(size_t) - 1U) / sizeof(size_t)) * sizeof(size_t)))
+
+/** Size of the storage required by a queue (bytes) */
+#define QUEUE_STORAGE_SIZE(buff_size, item_size) \
+  ((buff_size) * QUEUE_SLOT_SIZE(item_size))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Lock-free queue controller structure */
+typedef struct
+{
+  uint8_t*        buff;       /*!< Array of slots */
+  size_t          buff_size;  /*!< Queue size (# items, power of two) */
+  size_t          item_size;  /*!< Item size (bytes) */
+  size_t          slot_size;  /*!< Slot size (bytes) */
+  size_t          mask;       /*!< Slot index mask (buff_size - 1) */
+  /* Producers state */
+  volatile size_t tail BUFF_CACHE_ALIGNED;  /*!< Next push position */
+  /* Consumers state */
+  volatile size_t head BUFF_CACHE_ALIGNED;  /*!< Next pop position */
+} t_queue;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a queue instance
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl      Queue controller
+ * @param buff      Array of slots (QUEUE_STORAGE_SIZE(buff_size, item_size) bytes, size_t aligned)
+ * @param buff_size Queue size (# items, power of two)
+ * @param item_size Item size (bytes)
+ * @return Error code
+ */
+uint32_t queue_init(t_queue* ctrl, void* buff, size_t buff_size, size_t item_size);
+
+/**
+ * @brief Pushes an item into the queue
+ * @note  Lock-free, safe to call from several contexts at the same time
+ * @param ctrl      Queue controller
+ * @param item      Incoming item
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if the queue is full)
+ */
+uint32_t queue_push(t_queue* ctrl, const void* item);
+
+/**
+ * @brief Pops the oldest item from the queue
+ * @note  Lock-free, safe to call from several contexts at the same time
+ * @param ctrl      Queue controller
+ * @param item      Receiving item
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if the queue is empty)
+ */
+uint32_t queue_pop(t_queue* ctrl, void* item);
+
+/**
+ * @brief Returns if the queue is empty
+ * @note  The result is a snapshot: it may be outdated if other contexts are using the queue
+ * @param ctrl      Queue controller
+ * @return True if queue is empty
+ */
+bool queue_is_empty(const t_queue* ctrl);
+
+/**
+ * @brief Get the queue total size (capacity)
+ * @param ctrl      Queue controller
+ * @return Queue size (# items)
+ */
+size_t queue_get_size(const t_queue* ctrl);
+
+/**
+ * @brief Get the number of items stored in the queue
+ * @note  The result is a snapshot: it may be outdated if other contexts are using the queue
+ * @param ctrl      Queue controller
+ * @return Items stored (# items)
+ */
+size_t queue_get_count(const t_queue* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Queue -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_QUEUE_H_ */
@@ -0,0 +1,241 @@
+/**
+ *******************************************************************************
+ * @file    emblib32_rtos.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   RTOS support (HOST implementation)
+ * @note    POSIX mutex + condition variable events
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include "emblib32_core.h"
+#include "emblib32_rtos.h"
+
+#if EMBLIB32_HOST
+#include <time.h>
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup RTOS
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Clock used for the timeouts (monotonic where the condition variable supports it) */
+#if EMBLIB32_HOST
+  #if defined(__linux__)
+    #define RTOS_EVENT_CLOCK  CLOCK_MONOTONIC
+  #else
+    #define RTOS_EVENT_CLOCK  CLOCK_REALTIME
+  #endif
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+WEAK uint32_t rtos_get_time(void)
+{
+#if EMBLIB32_HOST
+  struct timespec now;
+
+  clock_gettime(RTOS_EVENT_CLOCK, &now);
+  return (uint32_t)((now.tv_sec * 1000U) + (now.tv_nsec / 1000000L));
+#else
+  return 0;
+#endif
+}
+
+uint32_t rtos_get_remaining(uint32_t start, uint32_t timeout)
+{
+  uint32_t elapsed;
+
+  if (timeout == RTOS_WAIT_FOREVER)
+  {
+    return RTOS_WAIT_FOREVER;
+  }
+  elapsed = rtos_get_time() - start;
+  return (elapsed < timeout)? (timeout - elapsed) : 0U;
+}
+
+#if EMBLIB32_HOST
+uint32_t rtos_event_init(t_rtos_event* event)
+{
+  pthread_condattr_t attr;
+
+  /* Sanity check */
+  if (!event)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize event */
+  pthread_condattr_init(&attr);
+#if defined(__linux__)
+  pthread_condattr_setclock(&attr, RTOS_EVENT_CLOCK);
+#endif
+  pthread_mutex_init(&event->mutex, NULL);
+  pthread_cond_init(&event->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  event->count = 0;
+  return EMBLIB32_OK;
+}
+
+uint32_t rtos_event_deinit(t_rtos_event* event)
+{
+  /* Sanity check */
+  if (!event)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Release event */
+  pthread_cond_destroy(&event->cond);
+  pthread_mutex_destroy(&event->mutex);
+  return EMBLIB32_OK;
+}
+
+bool rtos_event_wait(void* object, uint32_t timeout)
+{
+  t_rtos_event*   event = (t_rtos_event*)object;
+  struct timespec deadline;
+  bool            signaled;
+  int             status = 0;
+
+  /* Sanity check */
+  if (!event)
+  {
+    return false;
+  }
+
+  /* Compute the deadline */
+  if (timeout != RTOS_WAIT_FOREVER)
+  {
+    clock_gettime(RTOS_EVENT_CLOCK, &deadline);
+    deadline.tv_sec  += (time_t)(timeout / 1000U);
+    deadline.tv_nsec += (long)(timeout % 1000U) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec  += 1;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+
+  /* Wait for a notification (one is consumed on wake-up) */
+  pthread_mutex_lock(&event->mutex);
+  while ((event->count == 0) && (status == 0))
+  {
+    if (timeout == RTOS_WAIT_FOREVER)
+    {
+      status = pthread_cond_wait(&event->cond, &event->mutex);
+    }
+    else
+    {
+      status = pthread_cond_timedwait(&event->cond, &event->mutex, &deadline);
+    }
+  }
+  signaled = (event->count != 0);
+  if (signaled)
+  {
+    event->count--;
+  }
+  pthread_mutex_unlock(&event->mutex);
+
+  return signaled;
+}
+
+void rtos_event_notify(void* object)
+{
+  t_rtos_event* event = (t_rtos_event*)object;
+
+  /* Sanity check */
+  if (!event)
+  {
+    return;
+  }
+
+  /* Count and wake up one waiting context */
+  pthread_mutex_lock(&event->mutex);
+  if (event->count != UINT32_MAX)
+  {
+    event->count++;
+  }
+  pthread_cond_signal(&event->cond);
+  pthread_mutex_unlock(&event->mutex);
+}
+#endif /* EMBLIB32_HOST */
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: RTOS -->
+*//*--------------------------------------------------------------------------*/
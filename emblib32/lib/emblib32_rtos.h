@@ -20,6 +20,13 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_core.h"
+
+#if EMBLIB32_HOST
+  #include <pthread.h>
+#endif
 
 /*-------------------------------------------------------------------------*//**
 * @addtogroup EmbLib32
@@ -33,6 +40,9 @@ extern "C" {
 * @{
 *//*--------------------------------------------------------------------------*/
 
+/** Wait without timeout */
+#define RTOS_WAIT_FOREVER     UINT32_MAX
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_Definitions -->
 *//*-----------------------------------------------------------------------*//**
@@ -54,6 +64,34 @@ extern "C" {
  */
 typedef void (*t_rtos_lock)(void *object, bool lock);
 
+/**
+ * @brief RTOS wait function: blocks until the event object is notified (counting semaphore semantics)
+ * @note  Each notification releases one wait, so several contexts may wait on the same event. With a binary
+ *        primitive (task notification, event group bit) only one context may wait on each event
+ * @param object  Event object
+ * @param timeout Timeout (ms). Zero polls, RTOS_WAIT_FOREVER blocks without timeout
+ * @return True if notified, false on timeout
+ */
+typedef bool (*t_rtos_wait)(void *object, uint32_t timeout);
+
+/**
+ * @brief RTOS notify function: wakes up a context waiting on the event object
+ * @note  Notifications are counted: n notifications before a wait release n waits. Waiters must re-check
+ *        their condition, a release may find the data already taken by another context
+ * @param object  Event object
+ */
+typedef void (*t_rtos_notify)(void *object);
+
+#if EMBLIB32_HOST
+/** Event object (HOST implementation, POSIX mutex + condition variable) */
+typedef struct
+{
+  pthread_mutex_t mutex;      /*!< Protects the notification count */
+  pthread_cond_t  cond;       /*!< Wakes up the waiting contexts */
+  uint32_t        count;      /*!< Pending notifications */
+} t_rtos_event;
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_Types -->
 *//*-----------------------------------------------------------------------*//**
@@ -68,6 +106,52 @@ typedef void (*t_rtos_lock)(void *object, bool lock);
 * @{
 *//*--------------------------------------------------------------------------*/
 
+/**
+ * @brief Get the time base used for the timeouts
+ * @note  Weak implementation: milliseconds on HOST, zero otherwise (timeouts then restart on every wake-up).
+ *        Override it with the RTOS tick count converted to milliseconds
+ * @return Timestamp (ms, free running)
+ */
+uint32_t rtos_get_time(void);
+
+/**
+ * @brief Get the time left until a timeout expires
+ * @param start   Timestamp taken when the wait started (rtos_get_time)
+ * @param timeout Timeout (ms). RTOS_WAIT_FOREVER never expires
+ * @return Time left (ms), zero once expired, RTOS_WAIT_FOREVER if the timeout is RTOS_WAIT_FOREVER
+ */
+uint32_t rtos_get_remaining(uint32_t start, uint32_t timeout);
+
+#if EMBLIB32_HOST
+/**
+ * @brief Initializes an event object
+ * @param event   Event object
+ * @return Error code
+ */
+uint32_t rtos_event_init(t_rtos_event* event);
+
+/**
+ * @brief Releases an event object
+ * @param event   Event object
+ * @return Error code
+ */
+uint32_t rtos_event_deinit(t_rtos_event* event);
+
+/**
+ * @brief Waits for an event object (t_rtos_wait implementation)
+ * @param object  Event object (t_rtos_event)
+ * @param timeout Timeout (ms). Zero polls, RTOS_WAIT_FOREVER blocks without timeout
+ * @return True if notified, false on timeout
+ */
+bool rtos_event_wait(void* object, uint32_t timeout);
+
+/**
+ * @brief Notifies an event object (t_rtos_notify implementation)
+ * @param object  Event object (t_rtos_event)
+ */
+void rtos_event_notify(void* object);
+#endif
+
 /*-------------------------------------------------------------------------*//**
 * @} <!-- End: PUBLIC_API -->
 *//*-----------------------------------------------------------------------*//**
@@ -0,0 +1,284 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_select.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Wait on several buffers at once.
+ * @note    Member buffers notify a single event object shared by the set
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+
+#include "emblib32_select.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Select
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static bool _select_ready(const t_select_member* member);
+static void _select_arm(const t_select* ctrl);
+static size_t _select_disarm(const t_select* ctrl);
+static uint32_t _select_waits(const t_select_member* member);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t select_init(t_select* ctrl, t_select_member* members, size_t size, t_rtos_wait wait, t_rtos_notify notify, void* event)
+{
+  /* Sanity check */
+  if (!ctrl || !members || (size == 0) || (size > SELECT_MAX_MEMBERS))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!wait || !notify || !event)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize set */
+  ctrl->members = members;
+  ctrl->size    = size;
+  ctrl->count   = 0;
+  ctrl->wait    = wait;
+  ctrl->notify  = notify;
+  ctrl->event   = event;
+  return EMBLIB32_OK;
+}
+
+uint32_t select_add(t_select* ctrl, t_buff* buff, uint32_t events)
+{
+  void* data_event;
+  void* space_event;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->members || !buff || (ctrl->count >= ctrl->size))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((events == 0) || (events & ~(uint32_t)(SELECT_READABLE | SELECT_WRITABLE)))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Only the requested directions wake up the set */
+  data_event  = (events & SELECT_READABLE)? ctrl->event : NULL;
+  space_event = (events & SELECT_WRITABLE)? ctrl->event : NULL;
+  if (buff_set_notify(buff, ctrl->wait, ctrl->notify, data_event, space_event) != EMBLIB32_OK)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  ctrl->members[ctrl->count].buff   = buff;
+  ctrl->members[ctrl->count].events = events;
+  ctrl->count++;
+  return EMBLIB32_OK;
+}
+
+uint32_t select_poll(const t_select* ctrl)
+{
+  uint32_t ready = 0;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->members)
+  {
+    return 0;
+  }
+
+  for (size_t idx = 0; idx < ctrl->count; idx++)
+  {
+    if (_select_ready(&ctrl->members[idx]))
+    {
+      ready |= (1UL << idx);
+    }
+  }
+  return ready;
+}
+
+uint32_t select_wait(t_select* ctrl, uint32_t timeout, uint32_t* ready)
+{
+  uint32_t mask;
+  uint32_t start;
+  size_t   pending;
+  bool     notified;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->members || !ready)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Check the members each time one of them notifies. Members only notify while the set is armed, so traffic
+     with nobody waiting leaves no notification behind */
+  start = rtos_get_time();
+  do
+  {
+    _select_arm(ctrl);
+    mask     = select_poll(ctrl);
+    notified = (mask == 0) && ctrl->wait(ctrl->event, rtos_get_remaining(start, timeout));
+
+    /* Consume the notifications sent meanwhile (the wake-up already took one) */
+    pending = _select_disarm(ctrl);
+    if (notified && (pending != 0))
+    {
+      pending--;
+    }
+    while (pending-- != 0)
+    {
+      ctrl->wait(ctrl->event, RTOS_WAIT_FOREVER);
+    }
+  } while (notified);
+
+  if (mask == 0)
+  {
+    mask = select_poll(ctrl);
+  }
+
+  *ready = mask;
+  return (mask == 0)? EMBLIB32_ERROR_SELECT_TIMEOUT : EMBLIB32_OK;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks if a member is ready for any of the events it waits for
+ * @param member Set member
+ * @return True if ready
+ */
+static bool _select_ready(const t_select_member* member)
+{
+  t_buff* buff = member->buff;
+
+  if ((member->events & SELECT_READABLE) && !buff_is_empty(buff))
+  {
+    return true;
+  }
+  if ((member->events & SELECT_WRITABLE) && ((buff->mode & BUFF_OPMODE_W_OVERFLOW) || !buff_is_full(buff)))
+  {
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Registers the set as a waiter on every member (see buff_wait_begin)
+ * @param ctrl Set controller
+ */
+static void _select_arm(const t_select* ctrl)
+{
+  for (size_t idx = 0; idx < ctrl->count; idx++)
+  {
+    buff_wait_begin(ctrl->members[idx].buff, _select_waits(&ctrl->members[idx]));
+  }
+}
+
+/**
+ * @brief Drops the set registrations on every member (see buff_wait_end)
+ * @param ctrl Set controller
+ * @return Number of notifications sent to the set event meanwhile
+ */
+static size_t _select_disarm(const t_select* ctrl)
+{
+  size_t pending = 0;
+
+  for (size_t idx = 0; idx < ctrl->count; idx++)
+  {
+    pending += buff_wait_end(ctrl->members[idx].buff, _select_waits(&ctrl->members[idx]));
+  }
+  return pending;
+}
+
+/**
+ * @brief Maps the events a member waits for to the buffer events
+ * @param member Set member
+ * @return Buffer events (see t_buff_wait)
+ */
+static uint32_t _select_waits(const t_select_member* member)
+{
+  uint32_t waits = 0;
+
+  if (member->events & SELECT_READABLE)
+  {
+    waits |= BUFF_WAIT_DATA;
+  }
+  if (member->events & SELECT_WRITABLE)
+  {
+    waits |= BUFF_WAIT_SPACE;
+  }
+  return waits;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Select -->
+*//*--------------------------------------------------------------------------*/
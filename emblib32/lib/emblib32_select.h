@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_select.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Wait on several buffers at once.
+ * @note    Member buffers notify a single event object shared by the set
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_SELECT_H_
+#define _EMBLIB32_SELECT_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+#include "emblib32_rtos.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Select
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/* Error codes */
+#define EMBLIB32_ERROR_SELECT_TIMEOUT   0x21U    /*!< No member got ready before the timeout */
+
+/** Maximum number of members of a set (one bit each on the ready mask) */
+#define SELECT_MAX_MEMBERS              32U
+
+/** Buffer events a member can wait for */
+typedef enum
+{
+  SELECT_READABLE   = 0x01,     /*!< The buffer holds items */
+  SELECT_WRITABLE   = 0x02,     /*!< The buffer accepts items (always true on BUFF_OPMODE_W_OVERFLOW) */
+} t_select_event;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Set member */
+typedef struct
+{
+  t_buff*         buff;       /*!< Member buffer */
+  uint32_t        events;     /*!< Events waited for (see t_select_event) */
+} t_select_member;
+
+/**
+ * Buffer set controller structure.
+ * Every member buffer notifies the set event object (data and/or space event, as requested) while the set
+ * waits, so a single context can block until any of them gets ready. On HOST use rtos_event_wait/rtos_event_notify with a
+ * t_rtos_event, on a RTOS any notification primitive works (task notification, event group bit, semaphore).
+ */
+typedef struct
+{
+  t_select_member* members;   /*!< Array of members */
+  size_t          size;       /*!< Maximum number of members */
+  size_t          count;      /*!< Number of members */
+  t_rtos_wait     wait;       /*!< Wait handler function */
+  t_rtos_notify   notify;     /*!< Notify handler function */
+  void*           event;      /*!< Event object shared by the members */
+} t_select;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a buffer set
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl      Set controller
+ * @param members   Array of members
+ * @param size      Maximum number of members (up to SELECT_MAX_MEMBERS)
+ * @param wait      Wait function handler
+ * @param notify    Notify function handler
+ * @param event     Event object (only the set may wait on it)
+ * @return Error code
+ */
+uint32_t select_init(t_select* ctrl, t_select_member* members, size_t size, t_rtos_wait wait, t_rtos_notify notify, void* event);
+
+/**
+ * @brief Adds a buffer to the set. Its bit on the ready mask is the order it was added in
+ * @note  This function is thread unsafe. Use with care
+ *        The buffer notify handlers are replaced (see buff_set_notify): from now on buff_push_wait and
+ *        buff_pop_wait must not be used on it, and it can't be a member of another set
+ * @param ctrl      Set controller
+ * @param buff      Member buffer
+ * @param events    Events waited for (see t_select_event)
+ * @return Error code
+ */
+uint32_t select_add(t_select* ctrl, t_buff* buff, uint32_t events);
+
+/**
+ * @brief Gets the members that are ready, without blocking
+ * @param ctrl      Set controller
+ * @return Ready mask (bit n set if member n is ready)
+ */
+uint32_t select_poll(const t_select* ctrl);
+
+/**
+ * @brief Blocks until any member is ready or the timeout expires
+ * @note  Only one context may wait on a set. If a member gets ready but is drained by another context before
+ *        it is checked, the wait goes on until the same deadline
+ * @param ctrl      Set controller
+ * @param timeout   Timeout (ms). Zero polls, RTOS_WAIT_FOREVER blocks without timeout
+ * @param ready     Ready mask (bit n set if member n is ready)
+ * @return Error code (EMBLIB32_ERROR_SELECT_TIMEOUT if no member got ready)
+ */
+uint32_t select_wait(t_select* ctrl, uint32_t timeout, uint32_t* ready);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Select -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_SELECT_H_ */
@@ -0,0 +1,297 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_telem.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lossy telemetry ring with per-slot sequence numbers.
+ * @note    The writer never waits, readers detect overwritten slots and count the lost items
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "emblib32_telem.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Telemetry
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Get the slot sequence stamp */
+#define TELEM_SEQ(slot)     ((volatile size_t*)(slot))
+
+/** Get the slot item */
+#define TELEM_ITEM(slot)    ((slot) + sizeof(size_t))
+
+/** Stamp of a slot holding a complete item for a given position (odd stamps: write in progress) */
+#define TELEM_STAMP(pos)    (((pos) << 1) + 2U)
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static uint8_t* _telem_slot(const t_telem* ctrl, size_t pos);
+static size_t _telem_oldest(const t_telem* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t telem_init(t_telem* ctrl, void* buff, size_t buff_size, size_t item_size)
+{
+  /* Sanity check */
+  if (!ctrl || !buff || (item_size == 0) || (buff_size < 2) || ((buff_size & (buff_size - 1)) != 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize ring */
+  ctrl->buff      = (uint8_t*)buff;
+  ctrl->buff_size = buff_size;
+  ctrl->item_size = item_size;
+  ctrl->slot_size = TELEM_SLOT_SIZE(item_size);
+  ctrl->mask      = buff_size - 1;
+  ctrl->tail      = 0;
+
+  /* No slot holds a complete item yet */
+  for (size_t pos = 0; pos < buff_size; pos++)
+  {
+    *TELEM_SEQ(_telem_slot(ctrl, pos)) = 0;
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t telem_write(t_telem* ctrl, const void* item)
+{
+  uint8_t* slot;
+  size_t   pos;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Odd stamp: readers must see the slot as invalid before its contents start changing */
+  pos  = ATOMIC_LOAD_RELAXED(&ctrl->tail);
+  slot = _telem_slot(ctrl, pos);
+  ATOMIC_STORE_RELEASE(TELEM_SEQ(slot), (TELEM_STAMP(pos) - 1U));
+  ATOMIC_FENCE_RELEASE();
+  memcpy(TELEM_ITEM(slot), item, ctrl->item_size);
+
+  /* Even stamp: the item is complete */
+  ATOMIC_STORE_RELEASE(TELEM_SEQ(slot), TELEM_STAMP(pos));
+  ATOMIC_STORE_RELEASE(&ctrl->tail, (pos + 1));
+  return EMBLIB32_OK;
+}
+
+uint32_t telem_reader_init(const t_telem* ctrl, t_telem_reader* reader)
+{
+  /* Sanity check */
+  if (!ctrl || !reader)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  reader->cursor = _telem_oldest(ctrl);
+  reader->lost   = 0;
+  return EMBLIB32_OK;
+}
+
+uint32_t telem_read(const t_telem* ctrl, t_telem_reader* reader, void* item, uint32_t* lost)
+{
+  uint8_t*  slot;
+  size_t    seq;
+  size_t    pos;
+  size_t    oldest;
+  ptrdiff_t diff;
+  uint32_t  skipped = 0;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff || !reader || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  pos = reader->cursor;
+  for (;;)
+  {
+    slot = _telem_slot(ctrl, pos);
+    seq  = ATOMIC_LOAD_ACQUIRE(TELEM_SEQ(slot));
+    diff = (ptrdiff_t)(seq - TELEM_STAMP(pos));
+    if (diff < 0)
+    {
+      /* Slot not written yet (or being written for this position) */
+      memset(item, 0x00, ctrl->item_size);
+      reader->cursor  = pos;
+      reader->lost   += skipped;
+      if (lost)
+      {
+        *lost = skipped;
+      }
+      return EMBLIB32_ERROR_BUFFER_EMPTY;
+    }
+    if (diff == 0)
+    {
+      /* Copy the item, it is only valid if the stamp didn't change meanwhile */
+      memcpy(item, TELEM_ITEM(slot), ctrl->item_size);
+      ATOMIC_FENCE_ACQUIRE();
+      if (ATOMIC_LOAD_RELAXED(TELEM_SEQ(slot)) == seq)
+      {
+        break;
+      }
+      continue;
+    }
+
+    /* Overwritten: skip to the oldest item the writer is not about to reuse */
+    oldest = _telem_oldest(ctrl);
+    if ((ptrdiff_t)(oldest - pos) <= 0)
+    {
+      oldest = pos + 1;
+    }
+    skipped += (uint32_t)(oldest - pos);
+    pos      = oldest;
+  }
+
+  reader->cursor  = pos + 1;
+  reader->lost   += skipped;
+  if (lost)
+  {
+    *lost = skipped;
+  }
+  return EMBLIB32_OK;
+}
+
+uint32_t telem_sync(const t_telem* ctrl, t_telem_reader* reader)
+{
+  /* Sanity check */
+  if (!ctrl || !reader)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  reader->cursor = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+  return EMBLIB32_OK;
+}
+
+size_t telem_get_count(const t_telem* ctrl, const t_telem_reader* reader)
+{
+  size_t tail;
+
+  /* Sanity check */
+  if (!ctrl || !reader)
+  {
+    return 0;
+  }
+
+  tail = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+  return ((ptrdiff_t)(tail - reader->cursor) > 0)? MIN((tail - reader->cursor), (ctrl->buff_size - 1)) : 0;
+}
+
+uint32_t telem_get_lost(const t_telem_reader* reader)
+{
+  /* Sanity check */
+  if (!reader)
+  {
+    return 0;
+  }
+
+  return reader->lost;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Gets the slot for a given position
+ * @param ctrl Telemetry ring controller
+ * @param pos  Position (free running)
+ * @return Slot address
+ */
+static uint8_t* _telem_slot(const t_telem* ctrl, size_t pos)
+{
+  return ctrl->buff + ((pos & ctrl->mask) * ctrl->slot_size);
+}
+
+/**
+ * @brief Gets the oldest position a reader may still get
+ * @note  The slot the writer fills next is excluded
+ * @param ctrl Telemetry ring controller
+ * @return Oldest position (free running)
+ */
+static size_t _telem_oldest(const t_telem* ctrl)
+{
+  size_t tail = ATOMIC_LOAD_ACQUIRE(&ctrl->tail);
+
+  return (tail >= ctrl->buff_size)? (tail - ctrl->buff_size + 1) : 0;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Telemetry -->
+*//*--------------------------------------------------------------------------*/
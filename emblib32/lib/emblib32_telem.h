@@ -0,0 +1,175 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_telem.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lossy telemetry ring with per-slot sequence numbers.
+ * @note    The writer never waits, readers detect overwritten slots and count the lost items
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_TELEM_H_
+#define _EMBLIB32_TELEM_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Telemetry
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Size of a telemetry slot: sequence stamp + item (padded to keep the stamps aligned) */
+#define TELEM_SLOT_SIZE(item_size) \
+  (sizeof(size_t) + ((((item_size) + sizeof(size_t) - 1U) / sizeof(size_t)) * sizeof(size_t)))
+
+/** Size of the storage required by a telemetry ring (bytes) */
+#define TELEM_STORAGE_SIZE(buff_size, item_size) \
+  ((buff_size) * TELEM_SLOT_SIZE(item_size))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Telemetry reader state (one per reader, owned by the reader context) */
+typedef struct
+{
+  size_t          cursor;     /*!< Next read position (free running) */
+  uint32_t        lost;       /*!< Items lost because the writer overwrote them */
+} t_telem_reader;
+
+/**
+ * Telemetry ring controller structure (one writer, any number of readers).
+ * Every slot is stamped with the position it holds: odd while the writer fills it, even once complete. The
+ * writer never looks at the readers, so they can be added or dropped at any time. A reader whose slot holds a
+ * newer stamp was overrun: it jumps to the oldest item the writer is not about to reuse.
+ */
+typedef struct
+{
+  uint8_t*        buff;       /*!< Array of slots */
+  size_t          buff_size;  /*!< Ring size (# items, power of two) */
+  size_t          item_size;  /*!< Item size (bytes) */
+  size_t          slot_size;  /*!< Slot size (bytes) */
+  size_t          mask;       /*!< Slot index mask (buff_size - 1) */
+  /* Writer state */
+  volatile size_t tail BUFF_CACHE_ALIGNED;  /*!< Next write position (free running) */
+} t_telem;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a telemetry ring instance
+ * @note  This function is thread unsafe. Use with care
+ *        A reader holds up to buff_size - 1 items: the slot next to be written is never handed out
+ * @param ctrl      Telemetry ring controller
+ * @param buff      Array of slots (TELEM_STORAGE_SIZE(buff_size, item_size) bytes, size_t aligned)
+ * @param buff_size Ring size (# items, power of two)
+ * @param item_size Item size (bytes)
+ * @return Error code
+ */
+uint32_t telem_init(t_telem* ctrl, void* buff, size_t buff_size, size_t item_size);
+
+/**
+ * @brief Writes an item, overwriting the oldest one if the ring is full
+ * @note  Wait-free, safe to call from an ISR. Only one context may write
+ * @param ctrl      Telemetry ring controller
+ * @param item      Incoming item
+ * @return Error code
+ */
+uint32_t telem_write(t_telem* ctrl, const void* item);
+
+/**
+ * @brief Attaches a reader to the ring. It starts on the oldest item available
+ * @note  Must be called from the reader context. The writer may keep running
+ * @param ctrl      Telemetry ring controller
+ * @param reader    Reader state
+ * @return Error code
+ */
+uint32_t telem_reader_init(const t_telem* ctrl, t_telem_reader* reader);
+
+/**
+ * @brief Reads the oldest item of a reader
+ * @note  Lock-free. The items overwritten since the last read are skipped and added to the reader lost count
+ * @param ctrl      Telemetry ring controller
+ * @param reader    Reader state
+ * @param item      Receiving item
+ * @param lost      Returns the number of items skipped before this one (may be NULL)
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if the reader is up to date)
+ */
+uint32_t telem_read(const t_telem* ctrl, t_telem_reader* reader, void* item, uint32_t* lost);
+
+/**
+ * @brief Drops the pending items of a reader (jumps to the newest position)
+ * @param ctrl      Telemetry ring controller
+ * @param reader    Reader state
+ * @return Error code
+ */
+uint32_t telem_sync(const t_telem* ctrl, t_telem_reader* reader);
+
+/**
+ * @brief Get the number of items pending for a reader
+ * @note  The result is a snapshot: the writer may overwrite some of them before they are read
+ * @param ctrl      Telemetry ring controller
+ * @param reader    Reader state
+ * @return Items pending (# items)
+ */
+size_t telem_get_count(const t_telem* ctrl, const t_telem_reader* reader);
+
+/**
+ * @brief Get the number of items a reader lost
+ * @param reader    Reader state
+ * @return Items lost (# items)
+ */
+uint32_t telem_get_lost(const t_telem_reader* reader);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Telemetry -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_TELEM_H_ */
@@ -0,0 +1,400 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_tier.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Tiered buffer: RAM ring backed by a file store (HOST only).
+ * @note    Bursts that don't fit on RAM are spilled to an append-only file in batches
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "emblib32_tier.h"
+
+#if TIER_SUPPORT == 1U
+#include <fcntl.h>
+#include <unistd.h>
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Tier
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Bounce buffer used to compact the file store (bytes) */
+#ifndef TIER_COMPACT_CHUNK
+  #define TIER_COMPACT_CHUNK          512U
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void _tier_lock(t_tier* ctrl, bool lock);
+static uint32_t _tier_spill(t_tier* ctrl);
+static uint32_t _tier_refill(t_tier* ctrl);
+static uint32_t _tier_compact(t_tier* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t tier_init(t_tier* ctrl, t_buff* ram, size_t threshold, void* batch, size_t batch_size, const char* path)
+{
+  /* Sanity check */
+  if (!ctrl || !ram || !ram->buff || !batch || (batch_size == 0) || !path)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (!(ram->mode & BUFF_OPMODE_R_FIFO) || (ram->mode & BUFF_OPMODE_W_OVERFLOW) || (threshold == 0) || (threshold > ram->buff_size))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Create the file store */
+  ctrl->fd = open(path, (O_RDWR | O_CREAT | O_TRUNC), 0600);
+  if (ctrl->fd < 0)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize tiers */
+  ctrl->ram         = ram;
+  ctrl->threshold   = threshold;
+  ctrl->batch       = (uint8_t*)batch;
+  ctrl->batch_size  = batch_size;
+  ctrl->batch_count = 0;
+  ctrl->path        = path;
+  ctrl->file_head   = 0;
+  ctrl->file_tail   = 0;
+  ctrl->lock        = NULL;
+  ctrl->object      = NULL;
+  return buff_clear(ram);
+}
+
+uint32_t tier_deinit(t_tier* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl || (ctrl->fd < 0))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Drop the file store */
+  close(ctrl->fd);
+  unlink(ctrl->path);
+  ctrl->fd = -1;
+  return EMBLIB32_OK;
+}
+
+uint32_t tier_set_lock(t_tier* ctrl, t_rtos_lock lock, void* object)
+{
+  /* Validate */
+  if (!ctrl || !lock)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  /* Update */
+  ctrl->lock   = lock;
+  ctrl->object = object;
+  return EMBLIB32_OK;
+}
+
+uint32_t tier_push(t_tier* ctrl, const void* item)
+{
+  uint32_t status = EMBLIB32_OK;
+  size_t   item_size;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->ram || (ctrl->fd < 0) || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _tier_lock(ctrl, true);
+
+  /* RAM while nothing was spilled and it is below the threshold, write batch otherwise (keeps FIFO order) */
+  item_size = ctrl->ram->item_size;
+  if ((ctrl->file_head == ctrl->file_tail) && (ctrl->batch_count == 0) && (buff_get_count(ctrl->ram) < ctrl->threshold))
+  {
+    status = buff_push(ctrl->ram, item);
+  }
+  else
+  {
+    memcpy((ctrl->batch + (ctrl->batch_count * item_size)), item, item_size);
+    ctrl->batch_count++;
+    if (ctrl->batch_count == ctrl->batch_size)
+    {
+      status = _tier_spill(ctrl);
+      if (status != EMBLIB32_OK)
+      {
+        /* Reject the item, the batch is written on the next attempt */
+        ctrl->batch_count--;
+      }
+    }
+  }
+
+  _tier_lock(ctrl, false);
+
+  return status;
+}
+
+uint32_t tier_pop(t_tier* ctrl, void* item)
+{
+  uint32_t status;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->ram || (ctrl->fd < 0) || !item)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  _tier_lock(ctrl, true);
+
+  /* Process */
+  if (buff_is_empty(ctrl->ram))
+  {
+    _tier_refill(ctrl);
+  }
+  status = buff_pop(ctrl->ram, item);
+  if (buff_get_count(ctrl->ram) < ctrl->threshold)
+  {
+    _tier_refill(ctrl);
+  }
+
+  _tier_lock(ctrl, false);
+
+  return status;
+}
+
+size_t tier_get_count(t_tier* ctrl)
+{
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->ram)
+  {
+    return 0;
+  }
+
+  _tier_lock(ctrl, true);
+  count = buff_get_count(ctrl->ram) + (ctrl->file_tail - ctrl->file_head) + ctrl->batch_count;
+  _tier_lock(ctrl, false);
+
+  return count;
+}
+
+size_t tier_get_spilled(t_tier* ctrl)
+{
+  size_t count;
+
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  _tier_lock(ctrl, true);
+  count = (ctrl->file_tail - ctrl->file_head) + ctrl->batch_count;
+  _tier_lock(ctrl, false);
+
+  return count;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Locks/unlocks the tiered buffer
+ * @param ctrl Tiered buffer controller
+ * @param lock True to lock, false to unlock
+ */
+static void _tier_lock(t_tier* ctrl, bool lock)
+{
+  if (ctrl->lock)
+  {
+    ctrl->lock(ctrl->object, lock);
+  }
+}
+
+/**
+ * @brief Appends the write batch to the file store (one sequential write)
+ * @param ctrl Tiered buffer controller
+ * @return Error code
+ */
+static uint32_t _tier_spill(t_tier* ctrl)
+{
+  size_t  item_size = ctrl->ram->item_size;
+  size_t  bytes     = ctrl->batch_count * item_size;
+  ssize_t written;
+
+  written = pwrite(ctrl->fd, ctrl->batch, bytes, (off_t)(ctrl->file_tail * item_size));
+  if ((written < 0) || ((size_t)written != bytes))
+  {
+    return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+  ctrl->file_tail  += ctrl->batch_count;
+  ctrl->batch_count = 0;
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Moves the oldest spilled items back into the RAM ring
+ * @note  The file store is read straight into the free RAM regions (up to two reads). The write batch is only
+ *        moved once the file store is empty, so the FIFO order is kept
+ * @param ctrl Tiered buffer controller
+ * @return Error code
+ */
+static uint32_t _tier_refill(t_tier* ctrl)
+{
+  size_t  item_size = ctrl->ram->item_size;
+  void*   region;
+  size_t  size;
+  size_t  pushed;
+  ssize_t bytes;
+
+  /* File store */
+  while (ctrl->file_head != ctrl->file_tail)
+  {
+    size = ctrl->file_tail - ctrl->file_head;
+    if (buff_reserve(ctrl->ram, &region, &size) != EMBLIB32_OK)
+    {
+      /* RAM full: the file keeps live items, drop its consumed prefix once it dominates */
+      if ((ctrl->file_head >= TIER_COMPACT_THRESHOLD) && (ctrl->file_head >= (ctrl->file_tail - ctrl->file_head)))
+      {
+        return _tier_compact(ctrl);
+      }
+      return EMBLIB32_OK;
+    }
+    bytes = pread(ctrl->fd, region, (size * item_size), (off_t)(ctrl->file_head * item_size));
+    if ((bytes < 0) || ((size_t)bytes != (size * item_size)))
+    {
+      return EMBLIB32_ERROR_BUFFER_EMPTY;
+    }
+    buff_commit(ctrl->ram, size);
+    ctrl->file_head += size;
+  }
+  if (ctrl->file_tail != 0)
+  {
+    /* Drained: start over to keep the file small */
+    if (ftruncate(ctrl->fd, 0) == 0)
+    {
+      ctrl->file_head = 0;
+      ctrl->file_tail = 0;
+    }
+  }
+
+  /* Write batch */
+  if (ctrl->batch_count != 0)
+  {
+    buff_push_chunk(ctrl->ram, ctrl->batch, ctrl->batch_count, &pushed);
+    ctrl->batch_count -= pushed;
+    memmove(ctrl->batch, (ctrl->batch + (pushed * item_size)), (ctrl->batch_count * item_size));
+  }
+  return EMBLIB32_OK;
+}
+
+/**
+ * @brief Moves the items left on the file store to its start and shrinks it
+ * @note  Only called once the consumed prefix is at least as long as the items left: the copy never overlaps
+ *        them, so a failed compaction leaves the file store intact. Its cost is amortized over the items consumed
+ * @param ctrl Tiered buffer controller
+ * @return Error code
+ */
+static uint32_t _tier_compact(t_tier* ctrl)
+{
+  size_t   item_size = ctrl->ram->item_size;
+  size_t   count     = ctrl->file_tail - ctrl->file_head;
+  size_t   bytes     = count * item_size;
+  off_t    source    = (off_t)(ctrl->file_head * item_size);
+  uint8_t  chunk[TIER_COMPACT_CHUNK];
+  size_t   size;
+
+  for (size_t offset = 0; offset < bytes; offset += size)
+  {
+    size = MIN(sizeof(chunk), (bytes - offset));
+    if ((pread(ctrl->fd, chunk, size, (source + (off_t)offset)) != (ssize_t)size) ||
+        (pwrite(ctrl->fd, chunk, size, (off_t)offset) != (ssize_t)size))
+    {
+      return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+    }
+  }
+  if (ftruncate(ctrl->fd, (off_t)bytes) != 0)
+  {
+    return EMBLIB32_ERROR_BUFFER_OVERFLOW;
+  }
+  ctrl->file_head = 0;
+  ctrl->file_tail = count;
+  return EMBLIB32_OK;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Tier -->
+*//*--------------------------------------------------------------------------*/
+#endif /* TIER_SUPPORT */
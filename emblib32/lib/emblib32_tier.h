@@ -0,0 +1,186 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_tier.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Tiered buffer: RAM ring backed by a file store (HOST only).
+ * @note    Bursts that don't fit on RAM are spilled to an append-only file in batches
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_TIER_H_
+#define _EMBLIB32_TIER_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+#include "emblib32_rtos.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Tier
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Tiered buffer support (requires a POSIX file system) */
+#ifndef TIER_SUPPORT
+  #if (EMBLIB32_HOST) && (defined(__unix__) || defined(__APPLE__))
+    #define TIER_SUPPORT                1U
+  #else
+    #define TIER_SUPPORT                0U
+  #endif
+#endif
+
+/**
+ * Items consumed from the file store before it is compacted. The file is truncated whenever it drains, a writer
+ * that never lets it drain triggers a compaction once the consumed prefix passes this size and the items left
+ */
+#ifndef TIER_COMPACT_THRESHOLD
+  #define TIER_COMPACT_THRESHOLD        1024U
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#if TIER_SUPPORT == 1U
+/**
+ * Tiered buffer controller structure.
+ * Items are kept in FIFO order across three tiers: the RAM ring (oldest), the file store and the write batch
+ * (newest). Once the RAM ring reaches the threshold new items go to the write batch, which is appended to the
+ * file when full. As the consumer drains the RAM ring it is refilled from the file, then from the write batch.
+ */
+typedef struct
+{
+  t_buff*         ram;        /*!< RAM ring (FIFO, no overflow) */
+  size_t          threshold;  /*!< RAM occupancy that starts spilling (# items) */
+  uint8_t*        batch;      /*!< Write batch (newest items) */
+  size_t          batch_size; /*!< Write batch size (# items) */
+  size_t          batch_count;/*!< Items on the write batch */
+  int             fd;         /*!< File store descriptor */
+  const char*     path;       /*!< File store path */
+  size_t          file_head;  /*!< File store first item (# items) */
+  size_t          file_tail;  /*!< File store end (# items) */
+  /* RTOS support */
+  t_rtos_lock     lock;       /*!< Lock handler function */
+  void*           object;     /*!< Lock object */
+} t_tier;
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#if TIER_SUPPORT == 1U
+/**
+ * @brief Initializes a tiered buffer instance
+ * @note  This function is thread unsafe. Use with care
+ *        The file store is created (or truncated) and removed by tier_deinit. From now on the RAM ring must
+ *        only be accessed through the tier API
+ * @param ctrl        Tiered buffer controller
+ * @param ram         RAM ring (FIFO mode, no overflow). It is cleared
+ * @param threshold   RAM occupancy that starts spilling (# items, 1 to the RAM ring size)
+ * @param batch       Write batch (batch_size items)
+ * @param batch_size  Write batch size (# items): the file store is written in batches of this size
+ * @param path        File store path
+ * @return Error code
+ */
+uint32_t tier_init(t_tier* ctrl, t_buff* ram, size_t threshold, void* batch, size_t batch_size, const char* path);
+
+/**
+ * @brief Releases a tiered buffer instance (the file store is closed and removed)
+ * @note  This function is thread unsafe. Use with care
+ * @param ctrl        Tiered buffer controller
+ * @return Error code
+ */
+uint32_t tier_deinit(t_tier* ctrl);
+
+/**
+ * @brief Set a lock function handler for the tiered buffer
+ * @param ctrl        Tiered buffer controller
+ * @param lock        Lock function handler
+ * @param object      Lock object
+ * @return Error code
+ */
+uint32_t tier_set_lock(t_tier* ctrl, t_rtos_lock lock, void* object);
+
+/**
+ * @brief Pushes an item into the tiered buffer
+ * @param ctrl        Tiered buffer controller
+ * @param item        Incoming item
+ * @return Error code (EMBLIB32_ERROR_BUFFER_OVERFLOW if the file store can't be written)
+ */
+uint32_t tier_push(t_tier* ctrl, const void* item);
+
+/**
+ * @brief Pops the oldest item from the tiered buffer
+ * @note  The RAM ring is refilled from the spilled items once it drops below the threshold. The file store is
+ *        truncated when it drains, or compacted (see TIER_COMPACT_THRESHOLD) if it never does
+ * @param ctrl        Tiered buffer controller
+ * @param item        Receiving item
+ * @return Error code
+ */
+uint32_t tier_pop(t_tier* ctrl, void* item);
+
+/**
+ * @brief Get the number of items stored on all the tiers
+ * @param ctrl        Tiered buffer controller
+ * @return Items stored (# items)
+ */
+size_t tier_get_count(t_tier* ctrl);
+
+/**
+ * @brief Get the number of items spilled out of the RAM ring (file store and write batch)
+ * @param ctrl        Tiered buffer controller
+ * @return Items spilled (# items)
+ */
+size_t tier_get_spilled(t_tier* ctrl);
+#endif /* TIER_SUPPORT */
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Tier -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_TIER_H_ */
@@ -0,0 +1,469 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_window.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Sliding-window statistics over a buffer of samples.
+ * @note    Aggregates are updated on every push/evict: O(1) sums, O(1) amortized min/max, O(log n) median
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#include <stddef.h>
+
+#include "emblib32_window.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Window
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void _window_insert(t_window* ctrl, int32_t value, uint32_t slot);
+static void _window_evict(t_window* ctrl, int32_t value, uint32_t slot);
+static void _window_deque_push(const t_window* ctrl, t_window_deque* deque, t_window_entry entry, bool max);
+static void _window_heap_insert(t_window* ctrl, t_window_heap* heap, t_window_entry entry);
+static t_window_entry _window_heap_remove(t_window* ctrl, t_window_heap* heap, size_t index);
+static void _window_heap_up(t_window* ctrl, t_window_heap* heap, size_t index);
+static void _window_heap_down(t_window* ctrl, t_window_heap* heap, size_t index);
+static void _window_heap_set(t_window* ctrl, t_window_heap* heap, size_t index, t_window_entry entry);
+static bool _window_heap_before(const t_window_heap* heap, const t_window_entry* a, const t_window_entry* b);
+static void _window_rebalance(t_window* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+uint32_t window_init(t_window* ctrl, t_buff* buff, void* storage)
+{
+  t_window_entry* entry = (t_window_entry*)storage;
+  size_t          size;
+
+  /* Sanity check */
+  if (!ctrl || !buff || !buff->buff || !storage)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if ((buff->item_size != sizeof(int32_t)) || !(buff->mode & BUFF_OPMODE_R_FIFO) || (buff->buff_size > UINT32_MAX))
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Initialize window: deques, heaps (the lower half takes the spare entry) and positions */
+  size            = buff_get_size(buff);
+  ctrl->buff      = buff;
+  ctrl->size      = size;
+  ctrl->min.entry = entry;
+  ctrl->max.entry = entry + size;
+  ctrl->lo.entry  = entry + (2 * size);
+  ctrl->lo.base   = 0;
+  ctrl->lo.max    = true;
+  ctrl->hi.base   = (size / 2) + 1;
+  ctrl->hi.entry  = ctrl->lo.entry + ctrl->hi.base;
+  ctrl->hi.max    = false;
+  ctrl->pos       = (uint32_t*)(entry + (3 * size) + 1);
+  return window_clear(ctrl);
+}
+
+uint32_t window_clear(t_window* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Process */
+  ctrl->count     = 0;
+  ctrl->slot      = 0;
+  ctrl->sum       = 0;
+  ctrl->sum_sq    = 0;
+  ctrl->min.head  = 0;
+  ctrl->min.count = 0;
+  ctrl->max.head  = 0;
+  ctrl->max.count = 0;
+  ctrl->lo.count  = 0;
+  ctrl->hi.count  = 0;
+  return buff_clear(ctrl->buff);
+}
+
+uint32_t window_push(t_window* ctrl, int32_t sample)
+{
+  uint32_t status;
+  int32_t  oldest;
+
+  /* Sanity check */
+  if (!ctrl || !ctrl->buff)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+
+  /* Evict the oldest sample (it sits on the slot about to be reused) */
+  if (ctrl->count == ctrl->size)
+  {
+    status = buff_pop(ctrl->buff, &oldest);
+    if (status != EMBLIB32_OK)
+    {
+      return status;
+    }
+    _window_evict(ctrl, oldest, (uint32_t)ctrl->slot);
+  }
+
+  /* Add the new one */
+  status = buff_push(ctrl->buff, &sample);
+  if (status != EMBLIB32_OK)
+  {
+    return status;
+  }
+  _window_insert(ctrl, sample, (uint32_t)ctrl->slot);
+  ctrl->slot = ((ctrl->slot + 1) < ctrl->size)? (ctrl->slot + 1) : 0;
+  return EMBLIB32_OK;
+}
+
+uint32_t window_get_stats(const t_window* ctrl, t_window_stats* stats)
+{
+  int64_t count;
+
+  /* Sanity check */
+  if (!ctrl || !stats)
+  {
+    return EMBLIB32_ERROR_PARAMETER;
+  }
+  if (ctrl->count == 0)
+  {
+    return EMBLIB32_ERROR_BUFFER_EMPTY;
+  }
+
+  /* Process */
+  count          = (int64_t)ctrl->count;
+  stats->count   = ctrl->count;
+  stats->sum     = ctrl->sum;
+  stats->sum_sq  = ctrl->sum_sq;
+  stats->min     = ctrl->min.entry[ctrl->min.head].value;
+  stats->max     = ctrl->max.entry[ctrl->max.head].value;
+  stats->mean    = (int32_t)(ctrl->sum / count);
+  stats->median  = ctrl->lo.entry[0].value;
+  if (ctrl->lo.count == ctrl->hi.count)
+  {
+    stats->median = (int32_t)(((int64_t)ctrl->lo.entry[0].value + ctrl->hi.entry[0].value) / 2);
+  }
+  /* N * sum_sq - sum^2 is exact (and fits) while the sum fits in 32 bits */
+  stats->variance = ((ctrl->count * ctrl->sum_sq) - (uint64_t)(ctrl->sum * ctrl->sum)) / (uint64_t)(count * count);
+  return EMBLIB32_OK;
+}
+
+size_t window_get_count(const t_window* ctrl)
+{
+  /* Sanity check */
+  if (!ctrl)
+  {
+    return 0;
+  }
+
+  return ctrl->count;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Adds a sample to the aggregates
+ * @param ctrl  Window controller
+ * @param value Sample value
+ * @param slot  Sample slot
+ */
+static void _window_insert(t_window* ctrl, int32_t value, uint32_t slot)
+{
+  t_window_entry entry = {value, slot};
+
+  /* Sums */
+  ctrl->sum    += value;
+  ctrl->sum_sq += (uint64_t)((int64_t)value * value);
+
+  /* Min/max candidates */
+  _window_deque_push(ctrl, &ctrl->min, entry, false);
+  _window_deque_push(ctrl, &ctrl->max, entry, true);
+
+  /* Median heaps */
+  if ((ctrl->lo.count == 0) || (value <= ctrl->lo.entry[0].value))
+  {
+    _window_heap_insert(ctrl, &ctrl->lo, entry);
+  }
+  else
+  {
+    _window_heap_insert(ctrl, &ctrl->hi, entry);
+  }
+  _window_rebalance(ctrl);
+  ctrl->count++;
+}
+
+/**
+ * @brief Removes the oldest sample from the aggregates
+ * @param ctrl  Window controller
+ * @param value Sample value
+ * @param slot  Sample slot
+ */
+static void _window_evict(t_window* ctrl, int32_t value, uint32_t slot)
+{
+  uint32_t pos = ctrl->pos[slot];
+
+  /* Sums */
+  ctrl->sum    -= value;
+  ctrl->sum_sq -= (uint64_t)((int64_t)value * value);
+
+  /* Min/max candidates: the oldest sample can only be at the front */
+  if (ctrl->min.entry[ctrl->min.head].slot == slot)
+  {
+    ctrl->min.head = ((ctrl->min.head + 1) < ctrl->size)? (ctrl->min.head + 1) : 0;
+    ctrl->min.count--;
+  }
+  if (ctrl->max.entry[ctrl->max.head].slot == slot)
+  {
+    ctrl->max.head = ((ctrl->max.head + 1) < ctrl->size)? (ctrl->max.head + 1) : 0;
+    ctrl->max.count--;
+  }
+
+  /* Median heaps */
+  if (pos < ctrl->hi.base)
+  {
+    _window_heap_remove(ctrl, &ctrl->lo, pos);
+  }
+  else
+  {
+    _window_heap_remove(ctrl, &ctrl->hi, (pos - ctrl->hi.base));
+  }
+  _window_rebalance(ctrl);
+  ctrl->count--;
+}
+
+/**
+ * @brief Adds an entry to a monotonic deque, dropping the entries it supersedes
+ * @note  A newer sample that is smaller (min) or bigger (max) than an older one outlives it on the window,
+ *        so the older one can never be the min/max again
+ * @param ctrl   Window controller
+ * @param deque  Deque
+ * @param entry  Incoming entry
+ * @param max    True for the max deque
+ */
+static void _window_deque_push(const t_window* ctrl, t_window_deque* deque, t_window_entry entry, bool max)
+{
+  size_t back;
+
+  while (deque->count != 0)
+  {
+    back = deque->head + deque->count - 1;
+    back = (back < ctrl->size)? back : (back - ctrl->size);
+    if (max? (deque->entry[back].value > entry.value) : (deque->entry[back].value < entry.value))
+    {
+      break;
+    }
+    deque->count--;
+  }
+  back = deque->head + deque->count;
+  back = (back < ctrl->size)? back : (back - ctrl->size);
+  deque->entry[back] = entry;
+  deque->count++;
+}
+
+/**
+ * @brief Inserts an entry into a heap
+ * @param ctrl   Window controller
+ * @param heap   Heap
+ * @param entry  Incoming entry
+ */
+static void _window_heap_insert(t_window* ctrl, t_window_heap* heap, t_window_entry entry)
+{
+  _window_heap_set(ctrl, heap, heap->count, entry);
+  heap->count++;
+  _window_heap_up(ctrl, heap, (heap->count - 1));
+}
+
+/**
+ * @brief Removes an entry from a heap (the last entry takes its place)
+ * @param ctrl   Window controller
+ * @param heap   Heap
+ * @param index  Entry index
+ * @return Removed entry
+ */
+static t_window_entry _window_heap_remove(t_window* ctrl, t_window_heap* heap, size_t index)
+{
+  t_window_entry removed = heap->entry[index];
+
+  heap->count--;
+  if (index != heap->count)
+  {
+    _window_heap_set(ctrl, heap, index, heap->entry[heap->count]);
+    if ((index > 0) && _window_heap_before(heap, &heap->entry[index], &heap->entry[(index - 1) / 2]))
+    {
+      _window_heap_up(ctrl, heap, index);
+    }
+    else
+    {
+      _window_heap_down(ctrl, heap, index);
+    }
+  }
+  return removed;
+}
+
+/**
+ * @brief Moves an entry up until its parent goes first
+ * @param ctrl   Window controller
+ * @param heap   Heap
+ * @param index  Entry index
+ */
+static void _window_heap_up(t_window* ctrl, t_window_heap* heap, size_t index)
+{
+  t_window_entry entry = heap->entry[index];
+  size_t         parent;
+
+  while (index > 0)
+  {
+    parent = (index - 1) / 2;
+    if (!_window_heap_before(heap, &entry, &heap->entry[parent]))
+    {
+      break;
+    }
+    _window_heap_set(ctrl, heap, index, heap->entry[parent]);
+    index = parent;
+  }
+  _window_heap_set(ctrl, heap, index, entry);
+}
+
+/**
+ * @brief Moves an entry down until it goes before its children
+ * @param ctrl   Window controller
+ * @param heap   Heap
+ * @param index  Entry index
+ */
+static void _window_heap_down(t_window* ctrl, t_window_heap* heap, size_t index)
+{
+  t_window_entry entry = heap->entry[index];
+  size_t         child;
+
+  while ((child = (2 * index) + 1) < heap->count)
+  {
+    if (((child + 1) < heap->count) && _window_heap_before(heap, &heap->entry[child + 1], &heap->entry[child]))
+    {
+      child++;
+    }
+    if (!_window_heap_before(heap, &heap->entry[child], &entry))
+    {
+      break;
+    }
+    _window_heap_set(ctrl, heap, index, heap->entry[child]);
+    index = child;
+  }
+  _window_heap_set(ctrl, heap, index, entry);
+}
+
+/**
+ * @brief Stores an entry on a heap and records its position
+ * @param ctrl   Window controller
+ * @param heap   Heap
+ * @param index  Entry index
+ * @param entry  Entry
+ */
+static void _window_heap_set(t_window* ctrl, t_window_heap* heap, size_t index, t_window_entry entry)
+{
+  heap->entry[index]    = entry;
+  ctrl->pos[entry.slot] = (uint32_t)(heap->base + index);
+}
+
+/**
+ * @brief Returns if an entry goes before another on a heap
+ * @param heap   Heap
+ * @param a      Entry
+ * @param b      Entry
+ * @return True if a goes first
+ */
+static bool _window_heap_before(const t_window_heap* heap, const t_window_entry* a, const t_window_entry* b)
+{
+  return heap->max? (a->value > b->value) : (a->value < b->value);
+}
+
+/**
+ * @brief Keeps the lower half equal to or one entry bigger than the upper half
+ * @param ctrl   Window controller
+ */
+static void _window_rebalance(t_window* ctrl)
+{
+  if (ctrl->lo.count > (ctrl->hi.count + 1))
+  {
+    _window_heap_insert(ctrl, &ctrl->hi, _window_heap_remove(ctrl, &ctrl->lo, 0));
+  }
+  else if (ctrl->hi.count > ctrl->lo.count)
+  {
+    _window_heap_insert(ctrl, &ctrl->lo, _window_heap_remove(ctrl, &ctrl->hi, 0));
+  }
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Window -->
+*//*--------------------------------------------------------------------------*/
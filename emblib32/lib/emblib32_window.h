@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ * @file    emblib32_window.h
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Sliding-window statistics over a buffer of samples.
+ * @note    Aggregates are updated on every push/evict: O(1) sums, O(1) amortized min/max, O(log n) median
+ * @warning None
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ ******************************************************************************
+ */
+#ifndef _EMBLIB32_WINDOW_H_
+#define _EMBLIB32_WINDOW_H_
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Window
+* @{
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * Size of the storage required by a window (bytes): min/max deques, median heaps (one spare entry) and the
+ * heap position of every sample
+ */
+#define WINDOW_STORAGE_SIZE(size) \
+  ((((3U * (size)) + 1U) * sizeof(t_window_entry)) + ((size) * sizeof(uint32_t)))
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Window entry: sample value and the slot it occupies in the window */
+typedef struct
+{
+  int32_t         value;      /*!< Sample value */
+  uint32_t        slot;       /*!< Sample slot (0 to size - 1) */
+} t_window_entry;
+
+/** Monotonic deque (min/max candidates, oldest first) */
+typedef struct
+{
+  t_window_entry* entry;      /*!< Array of entries (size) */
+  size_t          head;       /*!< First entry */
+  size_t          count;      /*!< Number of entries */
+} t_window_deque;
+
+/** Binary heap (lower half: max-heap, upper half: min-heap) */
+typedef struct
+{
+  t_window_entry* entry;      /*!< Array of entries */
+  size_t          base;       /*!< First entry position on the heaps storage */
+  size_t          count;      /*!< Number of entries */
+  bool            max;        /*!< Max-heap (largest value on top) */
+} t_window_heap;
+
+/** Window statistics snapshot */
+typedef struct
+{
+  size_t          count;      /*!< Samples on the window */
+  int64_t         sum;        /*!< Sum of the samples */
+  uint64_t        sum_sq;     /*!< Sum of the squared samples */
+  int32_t         min;        /*!< Smallest sample */
+  int32_t         max;        /*!< Largest sample */
+  int32_t         mean;       /*!< Mean (truncated) */
+  int32_t         median;     /*!< Median (mean of the two middle samples if count is even, truncated) */
+  uint64_t        variance;   /*!< Population variance (truncated) */
+} t_window_stats;
+
+/** Sliding-window statistics controller structure */
+typedef struct
+{
+  t_buff*         buff;       /*!< Samples buffer (int32_t items, FIFO) */
+  size_t          size;       /*!< Window size (# samples, buffer size) */
+  size_t          count;      /*!< Samples on the window */
+  size_t          slot;       /*!< Slot of the next sample */
+  int64_t         sum;        /*!< Running sum */
+  uint64_t        sum_sq;     /*!< Running sum of squares */
+  t_window_deque  min;        /*!< Min candidates (increasing values) */
+  t_window_deque  max;        /*!< Max candidates (decreasing values) */
+  t_window_heap   lo;         /*!< Lower half of the samples */
+  t_window_heap   hi;         /*!< Upper half of the samples */
+  uint32_t*       pos;        /*!< Heap position of every slot */
+} t_window;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_DATA
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_DATA -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a window instance attached to a samples buffer
+ * @note  This function is thread unsafe. Use with care
+ *        The buffer is cleared. From now on samples must be added with window_push only (reading them with
+ *        buff_peek/buff_peek_span is fine). Sums are exact while size * max|sample| < 2^31
+ * @param ctrl      Window controller
+ * @param buff      Samples buffer (int32_t items, FIFO mode). Its size is the window size
+ * @param storage   Window storage (WINDOW_STORAGE_SIZE(size) bytes, uint32_t aligned)
+ * @return Error code
+ */
+uint32_t window_init(t_window* ctrl, t_buff* buff, void* storage);
+
+/**
+ * @brief Clears the window and its samples buffer
+ * @param ctrl      Window controller
+ * @return Error code
+ */
+uint32_t window_clear(t_window* ctrl);
+
+/**
+ * @brief Adds a sample to the window (the oldest one is evicted if the window is full)
+ * @note  The window is not locked: use a single context or protect the calls
+ * @param ctrl      Window controller
+ * @param sample    Incoming sample
+ * @return Error code
+ */
+uint32_t window_push(t_window* ctrl, int32_t sample);
+
+/**
+ * @brief Get the window statistics
+ * @param ctrl      Window controller
+ * @param stats     Statistics snapshot
+ * @return Error code (EMBLIB32_ERROR_BUFFER_EMPTY if there are no samples)
+ */
+uint32_t window_get_stats(const t_window* ctrl, t_window_stats* stats);
+
+/**
+ * @brief Get the number of samples on the window
+ * @param ctrl      Window controller
+ * @return Samples stored (# samples)
+ */
+size_t window_get_count(const t_window* ctrl);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Window -->
+*//*--------------------------------------------------------------------------*/
+#ifdef  __cplusplus
+}
+#endif
+#endif /* _EMBLIB32_WINDOW_H_ */
@@ -0,0 +1,263 @@
+/**
+ *******************************************************************************
+ * @file    bench_emblib32_queue.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free MPMC queue throughput benchmark
+ * @note    Compares the queue against a mutex protected buffer
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+#include "emblib32_queue.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Queue
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define BENCH_SIZE        1024U       /*!< Queue/buffer size (# items) */
+#define BENCH_ITEMS       1000000U    /*!< Items moved per run (all threads) */
+#define BENCH_THREADS     16U         /*!< Maximum producer/consumer pairs */
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Benchmark target operations */
+typedef struct
+{
+  const char* name;
+  uint32_t    (*push)(const uint32_t* item);
+  uint32_t    (*pop)(uint32_t* item);
+} t_bench_target;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_queue               queue;
+size_t                queue_slots[QUEUE_STORAGE_SIZE(BENCH_SIZE, sizeof(uint32_t)) / sizeof(size_t)];
+t_buff                buff;
+uint32_t              buff_items[BENCH_SIZE];
+pthread_mutex_t       buff_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+const t_bench_target* target;
+size_t                thread_items;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static uint32_t bench_queue_push(const uint32_t* item);
+static uint32_t bench_queue_pop(uint32_t* item);
+static uint32_t bench_buff_push(const uint32_t* item);
+static uint32_t bench_buff_pop(uint32_t* item);
+static void bench_buff_lock(void* object, bool lock);
+
+static double bench_run(const t_bench_target* bench, size_t pairs);
+static void *bench_producer(void *arg);
+static void *bench_consumer(void *arg);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  const t_bench_target targets[] = {
+    {"queue (lock-free)", bench_queue_push, bench_queue_pop},
+    {"buffer (mutex)",    bench_buff_push,  bench_buff_pop},
+  };
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+  printf("Throughput (Mitems/s), %u items per run, %ld cores\n", BENCH_ITEMS, cores);
+  for (size_t pairs = 1U; pairs <= BENCH_THREADS; pairs <<= 1)
+  {
+    if ((pairs > 1U) && ((long)pairs > cores))
+    {
+      break;
+    }
+    printf("%2zu producer(s) / %2zu consumer(s):", pairs, pairs);
+    for (size_t idx = 0U; idx < ARRAY_SIZE(targets); idx++)
+    {
+      printf("  %s %8.2f", targets[idx].name, bench_run(&targets[idx], pairs));
+    }
+    printf("\n");
+  }
+  return 0;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static uint32_t bench_queue_push(const uint32_t* item)
+{
+  return queue_push(&queue, item);
+}
+
+static uint32_t bench_queue_pop(uint32_t* item)
+{
+  return queue_pop(&queue, item);
+}
+
+static uint32_t bench_buff_push(const uint32_t* item)
+{
+  return buff_push(&buff, item);
+}
+
+static uint32_t bench_buff_pop(uint32_t* item)
+{
+  return buff_pop(&buff, item);
+}
+
+static void bench_buff_lock(void* object, bool lock)
+{
+  if (lock)
+  {
+    pthread_mutex_lock((pthread_mutex_t*)object);
+  }
+  else
+  {
+    pthread_mutex_unlock((pthread_mutex_t*)object);
+  }
+}
+
+/**
+ * @brief Moves BENCH_ITEMS items through the target using N producer/consumer pairs
+ * @param bench     Benchmark target
+ * @param pairs     Number of producer/consumer pairs
+ * @return Throughput (millions of items per second)
+ */
+static double bench_run(const t_bench_target* bench, size_t pairs)
+{
+  pthread_t       producers[BENCH_THREADS];
+  pthread_t       consumers[BENCH_THREADS];
+  struct timespec start;
+  struct timespec end;
+  double          elapsed;
+
+  /* Prepare */
+  queue_init(&queue, queue_slots, BENCH_SIZE, sizeof(uint32_t));
+  buff_init(&buff, buff_items, BENCH_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true);
+  buff_set_lock(&buff, bench_buff_lock, &buff_mutex);
+  target       = bench;
+  thread_items = BENCH_ITEMS / pairs;
+
+  /* Run */
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (size_t idx = 0U; idx < pairs; idx++)
+  {
+    pthread_create(&consumers[idx], NULL, bench_consumer, NULL);
+    pthread_create(&producers[idx], NULL, bench_producer, NULL);
+  }
+  for (size_t idx = 0U; idx < pairs; idx++)
+  {
+    pthread_join(producers[idx], NULL);
+    pthread_join(consumers[idx], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  elapsed = (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) * 1e-9);
+  return ((double)(thread_items * pairs) / elapsed) * 1e-6;
+}
+
+static void *bench_producer(void *arg)
+{
+  UNUSED(arg);
+  for (uint32_t item = 0U; item < thread_items; )
+  {
+    if (target->push(&item) == EMBLIB32_OK)
+    {
+      item++;
+      continue;
+    }
+    sched_yield();
+  }
+  return NULL;
+}
+
+static void *bench_consumer(void *arg)
+{
+  uint32_t item;
+
+  UNUSED(arg);
+  for (size_t count = 0U; count < thread_items; )
+  {
+    if (target->pop(&item) == EMBLIB32_OK)
+    {
+      count++;
+      continue;
+    }
+    sched_yield();
+  }
+  return NULL;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Queue -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,339 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_bcast.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Broadcast ring testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "emblib32_core.h"
+#include "emblib32_bcast.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Broadcast
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define RING_SIZE         8U
+#define READERS           3U
+#define THREAD_ITEMS      100000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Test item: the sequence is repeated so torn reads can be detected */
+typedef struct
+{
+  uint32_t  seq[8];
+} t_test_item;
+
+/** Reader results */
+typedef struct
+{
+  uint32_t  received;           /*!< Items received */
+  bool      ordered;            /*!< Items arrived in order */
+  bool      consistent;         /*!< No torn item was received */
+} t_test_result;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_bcast         ctrl;
+t_test_item     items[RING_SIZE];
+t_bcast_reader  readers[READERS];
+t_test_result   results[READERS];
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_bcast_init(void);
+static void test_bcast_block(void);
+static void test_bcast_overwrite(void);
+static void test_bcast_threads(void);
+
+static void test_item_fill(t_test_item* item, uint32_t seq);
+static void *bcast_writer(void *arg);
+static void *bcast_reader(void *arg);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_bcast_init);
+  RUN_TEST(test_bcast_block);
+  RUN_TEST(test_bcast_overwrite);
+  RUN_TEST(test_bcast_threads);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_bcast_init(void)
+{
+  /* Sizes must be a power of two, one mode only */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bcast_init(&ctrl, items, 6U, sizeof(t_test_item), readers, READERS, BCAST_OPMODE_BLOCK));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bcast_init(&ctrl, items, RING_SIZE, sizeof(t_test_item), NULL, READERS, BCAST_OPMODE_BLOCK));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bcast_init(&ctrl, items, RING_SIZE, sizeof(t_test_item), readers, READERS, BCAST_OPMODE_BLOCK | BCAST_OPMODE_OVERWRITE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_init(&ctrl, items, RING_SIZE, sizeof(t_test_item), readers, READERS, BCAST_OPMODE_BLOCK));
+  TEST_ASSERT_EQUAL_UINT(RING_SIZE, bcast_get_size(&ctrl));
+  TEST_ASSERT_TRUE(bcast_is_empty(&ctrl, 0U));
+  TEST_ASSERT_FALSE(bcast_is_empty(&ctrl, READERS));
+}
+
+static void test_bcast_block(void)
+{
+  t_test_item item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_init(&ctrl, items, RING_SIZE, sizeof(t_test_item), readers, READERS, BCAST_OPMODE_BLOCK));
+  for (uint32_t seq = 0U; seq < RING_SIZE; seq++)
+  {
+    test_item_fill(&item, seq);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_push(&ctrl, &item));
+  }
+
+  /* Run: every reader gets every item, the slowest one holds the writer */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, bcast_push(&ctrl, &item));
+  for (size_t reader = 0U; reader < (READERS - 1U); reader++)
+  {
+    TEST_ASSERT_EQUAL_UINT(RING_SIZE, bcast_get_count(&ctrl, reader));
+    for (uint32_t seq = 0U; seq < RING_SIZE; seq++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_pop(&ctrl, reader, &item));
+      TEST_ASSERT_EQUAL_UINT32(seq, item.seq[0]);
+    }
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, bcast_pop(&ctrl, reader, &item));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, bcast_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_pop(&ctrl, (READERS - 1U), &item));
+  TEST_ASSERT_EQUAL_UINT32(0U, item.seq[0]);
+
+  /* Validate */
+  test_item_fill(&item, RING_SIZE);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(1U, bcast_get_count(&ctrl, 0U));
+  TEST_ASSERT_EQUAL_UINT(RING_SIZE, bcast_get_count(&ctrl, (READERS - 1U)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_sync(&ctrl, (READERS - 1U)));
+  TEST_ASSERT_TRUE(bcast_is_empty(&ctrl, (READERS - 1U)));
+  TEST_ASSERT_EQUAL_UINT32(0U, bcast_get_overruns(&ctrl, (READERS - 1U)));
+}
+
+static void test_bcast_overwrite(void)
+{
+  t_test_item item;
+  uint32_t    total = (3U * RING_SIZE) + 3U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_init(&ctrl, items, RING_SIZE, sizeof(t_test_item), readers, READERS, BCAST_OPMODE_OVERWRITE));
+
+  /* Run: the writer never waits */
+  for (uint32_t seq = 0U; seq < total; seq++)
+  {
+    test_item_fill(&item, seq);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_push(&ctrl, &item));
+    if (seq == 2U)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_pop(&ctrl, 0U, &item));
+      TEST_ASSERT_EQUAL_UINT32(0U, item.seq[0]);
+    }
+  }
+
+  /* Validate: lagging readers resume with the oldest item left and report what they lost */
+  TEST_ASSERT_EQUAL_UINT(RING_SIZE - 1U, bcast_get_count(&ctrl, 0U));
+  for (size_t reader = 0U; reader < READERS; reader++)
+  {
+    for (uint32_t seq = (total - (RING_SIZE - 1U)); seq < total; seq++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_pop(&ctrl, reader, &item));
+      TEST_ASSERT_EQUAL_UINT32(seq, item.seq[0]);
+    }
+    TEST_ASSERT_TRUE(bcast_is_empty(&ctrl, reader));
+  }
+  TEST_ASSERT_EQUAL_UINT32(total - RING_SIZE, bcast_get_overruns(&ctrl, 0U));
+  TEST_ASSERT_EQUAL_UINT32(total - (RING_SIZE - 1U), bcast_get_overruns(&ctrl, 1U));
+}
+
+static void test_bcast_threads(void)
+{
+  const uint16_t modes[] = {BCAST_OPMODE_BLOCK, BCAST_OPMODE_OVERWRITE};
+  pthread_t      writer;
+  pthread_t      threads[READERS];
+
+  for (size_t mode = 0U; mode < ARRAY_SIZE(modes); mode++)
+  {
+    /* Prepare */
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bcast_init(&ctrl, items, RING_SIZE, sizeof(t_test_item), readers, READERS, modes[mode]));
+    memset(results, 0, sizeof(results));
+
+    /* Run */
+    for (uintptr_t idx = 0U; idx < READERS; idx++)
+    {
+      TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[idx], NULL, bcast_reader, (void*)idx));
+    }
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, bcast_writer, NULL));
+    pthread_join(writer, NULL);
+    for (size_t idx = 0U; idx < READERS; idx++)
+    {
+      pthread_join(threads[idx], NULL);
+    }
+
+    /* Validate: every item was either received intact or reported as lost */
+    for (size_t idx = 0U; idx < READERS; idx++)
+    {
+      TEST_ASSERT_TRUE(results[idx].ordered);
+      TEST_ASSERT_TRUE(results[idx].consistent);
+      TEST_ASSERT_EQUAL_UINT32(THREAD_ITEMS, results[idx].received + bcast_get_overruns(&ctrl, idx));
+      if (modes[mode] == BCAST_OPMODE_BLOCK)
+      {
+        TEST_ASSERT_EQUAL_UINT32(THREAD_ITEMS, results[idx].received);
+      }
+    }
+  }
+}
+
+static void test_item_fill(t_test_item* item, uint32_t seq)
+{
+  for (size_t idx = 0U; idx < ARRAY_SIZE(item->seq); idx++)
+  {
+    item->seq[idx] = seq;
+  }
+}
+
+static void *bcast_writer(void *arg)
+{
+  t_test_item item;
+
+  UNUSED(arg);
+  for (uint32_t seq = 0U; seq < THREAD_ITEMS; )
+  {
+    test_item_fill(&item, seq);
+    if (bcast_push(&ctrl, &item) == EMBLIB32_OK)
+    {
+      seq++;
+      continue;
+    }
+    sched_yield();
+  }
+  return NULL;
+}
+
+static void *bcast_reader(void *arg)
+{
+  size_t         reader  = (size_t)(uintptr_t)arg;
+  t_test_result* result  = &results[reader];
+  uint32_t       next    = 0U;
+  t_test_item    item;
+
+  result->ordered    = true;
+  result->consistent = true;
+  while (next < THREAD_ITEMS)
+  {
+    if (bcast_pop(&ctrl, reader, &item) != EMBLIB32_OK)
+    {
+      sched_yield();
+      continue;
+    }
+    for (size_t idx = 1U; idx < ARRAY_SIZE(item.seq); idx++)
+    {
+      if (item.seq[idx] != item.seq[0])
+      {
+        result->consistent = false;
+      }
+    }
+    if (item.seq[0] < next)
+    {
+      result->ordered = false;
+    }
+    next = item.seq[0] + 1U;
+    result->received++;
+  }
+  return NULL;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Broadcast -->
+*//*--------------------------------------------------------------------------*/
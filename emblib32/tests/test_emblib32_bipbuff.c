@@ -0,0 +1,313 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_bipbuff.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Variable-length record buffer (bip-buffer) testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "emblib32_bipbuff.h"
+#include "emblib32_core.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup BipBuffer
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define BUFFER_SIZE       64U
+#define RECORD_MAX        24U
+#define RANDOM_STEPS      20000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_bipbuff ctrl;
+uint8_t   storage[BUFFER_SIZE];
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_bipbuff_records(void);
+static void test_bipbuff_wrap(void);
+static void test_bipbuff_reserve(void);
+static void test_bipbuff_random(void);
+
+static void fill_record(uint8_t* record, size_t size, uint8_t seed);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_bipbuff_records);
+  RUN_TEST(test_bipbuff_wrap);
+  RUN_TEST(test_bipbuff_reserve);
+  RUN_TEST(test_bipbuff_random);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_bipbuff_records(void)
+{
+  const char* lines[] = {"boot", "sensor ok", "x", "link up: 115200 baud"};
+  char        line[RECORD_MAX];
+  size_t      size;
+  size_t      used = 0;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bipbuff_init(&ctrl, storage, BIPBUFF_HEADER_SIZE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_init(&ctrl, storage, BUFFER_SIZE));
+  TEST_ASSERT_TRUE(bipbuff_is_empty(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, bipbuff_pop(&ctrl, line, sizeof(line), &size));
+
+  /* Run: records only use their own length plus the header */
+  for (size_t idx = 0; idx < ARRAY_SIZE(lines); idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_push(&ctrl, lines[idx], strlen(lines[idx])));
+    used += BIPBUFF_RECORD_SIZE(strlen(lines[idx]));
+  }
+  TEST_ASSERT_EQUAL_UINT(ARRAY_SIZE(lines), bipbuff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(used, bipbuff_get_used(&ctrl));
+
+  /* Validate */
+  for (size_t idx = 0; idx < ARRAY_SIZE(lines); idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_pop(&ctrl, line, sizeof(line), &size));
+    TEST_ASSERT_EQUAL_UINT(strlen(lines[idx]), size);
+    TEST_ASSERT_EQUAL_MEMORY(lines[idx], line, size);
+  }
+  TEST_ASSERT_TRUE(bipbuff_is_empty(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(0, bipbuff_get_used(&ctrl));
+}
+
+static void test_bipbuff_wrap(void)
+{
+  uint8_t record[RECORD_MAX];
+  uint8_t check[RECORD_MAX];
+  void*   region;
+  size_t  size;
+
+  /* Prepare: 3 records of 18 bytes (20 with header) -> 60 of 64 bytes used */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_init(&ctrl, storage, BUFFER_SIZE));
+  for (uint8_t idx = 0; idx < 3U; idx++)
+  {
+    fill_record(record, 18U, idx);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_push(&ctrl, record, 18U));
+  }
+  TEST_ASSERT_EQUAL_UINT(2U, bipbuff_get_available(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, bipbuff_push(&ctrl, record, 8U));
+
+  /* Run: free the first record, the next one wraps to the start and stays contiguous */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_consume(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(18U, bipbuff_get_available(&ctrl));
+  fill_record(record, 18U, 3U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_reserve(&ctrl, 18U, &region));
+  TEST_ASSERT_EQUAL_PTR(storage + BIPBUFF_HEADER_SIZE, region);
+  memcpy(region, record, 18U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_commit(&ctrl, 18U));
+  TEST_ASSERT_EQUAL_UINT(0U, bipbuff_get_available(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, bipbuff_push(&ctrl, record, 1U));
+
+  /* Validate: records come out in order, each one contiguous */
+  for (uint8_t idx = 1U; idx < 4U; idx++)
+  {
+    fill_record(check, 18U, idx);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_peek(&ctrl, &region, &size));
+    TEST_ASSERT_EQUAL_UINT(18U, size);
+    TEST_ASSERT_EQUAL_MEMORY(check, region, size);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_consume(&ctrl));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, bipbuff_consume(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE - BIPBUFF_HEADER_SIZE, bipbuff_get_available(&ctrl));
+}
+
+static void test_bipbuff_reserve(void)
+{
+  uint8_t record[RECORD_MAX];
+  uint8_t small[4];
+  void*   region;
+  size_t  size;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_init(&ctrl, storage, BUFFER_SIZE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bipbuff_commit(&ctrl, 1U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bipbuff_reserve(&ctrl, 0U, &region));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, bipbuff_reserve(&ctrl, BUFFER_SIZE, &region));
+
+  /* Run: reserve the worst case, commit the actual length */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_reserve(&ctrl, RECORD_MAX, &region));
+  fill_record(region, 10U, 7U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bipbuff_commit(&ctrl, RECORD_MAX + 1U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_commit(&ctrl, 10U));
+  TEST_ASSERT_EQUAL_UINT(BIPBUFF_RECORD_SIZE(10U), bipbuff_get_used(&ctrl));
+
+  /* Run: cancelled reservations do not store anything */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_reserve(&ctrl, RECORD_MAX, &region));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_commit(&ctrl, 0U));
+  TEST_ASSERT_EQUAL_UINT(1U, bipbuff_get_count(&ctrl));
+
+  /* Validate: records larger than the receiving buffer are kept */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_INDEX, bipbuff_pop(&ctrl, small, sizeof(small), &size));
+  TEST_ASSERT_EQUAL_UINT(0U, size);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_pop(&ctrl, record, sizeof(record), &size));
+  TEST_ASSERT_EQUAL_UINT(10U, size);
+  for (size_t idx = 0; idx < size; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)(7U + idx), record[idx]);
+  }
+
+  /* Validate: clear drops pending reservations */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_reserve(&ctrl, RECORD_MAX, &region));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_clear(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, bipbuff_commit(&ctrl, 1U));
+  TEST_ASSERT_TRUE(bipbuff_is_empty(&ctrl));
+}
+
+static void test_bipbuff_random(void)
+{
+  uint8_t record[RECORD_MAX];
+  uint8_t check[RECORD_MAX];
+  size_t  sizes[BUFFER_SIZE];
+  uint8_t seeds[BUFFER_SIZE];
+  size_t  head  = 0;
+  size_t  tail  = 0;
+  size_t  size;
+  uint8_t seed  = 0;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_init(&ctrl, storage, BUFFER_SIZE));
+  srand(1234);
+
+  /* Run: random pushes and pops checked against a reference FIFO of record descriptors */
+  for (size_t step = 0; step < RANDOM_STEPS; step++)
+  {
+    if ((rand() % 2) == 0)
+    {
+      size = 1U + ((size_t)rand() % RECORD_MAX);
+      fill_record(record, size, seed);
+      if (bipbuff_push(&ctrl, record, size) == EMBLIB32_OK)
+      {
+        sizes[tail % BUFFER_SIZE] = size;
+        seeds[tail % BUFFER_SIZE] = seed++;
+        tail++;
+      }
+      else
+      {
+        /* Only refused when there is no contiguous room for it */
+        TEST_ASSERT_LESS_THAN_UINT(size, bipbuff_get_available(&ctrl));
+      }
+    }
+    else if (head == tail)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, bipbuff_pop(&ctrl, record, sizeof(record), &size));
+    }
+    else
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, bipbuff_pop(&ctrl, record, sizeof(record), &size));
+      TEST_ASSERT_EQUAL_UINT(sizes[head % BUFFER_SIZE], size);
+      fill_record(check, size, seeds[head % BUFFER_SIZE]);
+      TEST_ASSERT_EQUAL_MEMORY(check, record, size);
+      head++;
+    }
+    TEST_ASSERT_EQUAL_UINT((tail - head), bipbuff_get_count(&ctrl));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT(BUFFER_SIZE, bipbuff_get_used(&ctrl));
+  }
+}
+
+static void fill_record(uint8_t* record, size_t size, uint8_t seed)
+{
+  for (size_t idx = 0; idx < size; idx++)
+  {
+    record[idx] = (uint8_t)(seed + idx);
+  }
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: BipBuffer -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,1310 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_buffer.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Generic buffer testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "emblib32_buffer.h"
+#include "emblib32_core.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Buffer
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define BUFFER_SIZE     8U
+#define SPSC_ITEMS      200000U
+#define PERSIST_PATH    "/tmp/emblib32_test_persist.bin"
+#define DMA_SIZE        64U
+#define DMA_ITEMS       200000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+BUFF_DEFINE(typed_odd, uint16_t, 5U)
+BUFF_DEFINE(typed_pow2, uint64_t, 4U)
+
+/** Persistent region: store followed by its items array */
+typedef struct
+{
+  t_buff_persist  store;
+  uint32_t        items[BUFFER_SIZE];
+} t_test_region;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_buff        ctrl;
+uint32_t      items[BUFFER_SIZE];
+t_rtos_event  data_event;
+t_rtos_event  space_event;
+size_t        watermarks[2];
+t_test_region region;
+volatile bool txn_pushed;
+size_t        wait_calls;
+uint8_t       dma_items[DMA_SIZE];
+volatile size_t dma_remaining;
+volatile size_t dma_consumed;
+volatile bool dma_overrun;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_buff_fifo(void);
+static void test_buff_lifo(void);
+static void test_buff_overflow(void);
+static void test_buff_chunk_wrap(void);
+static void test_buff_reserve(void);
+static void test_buff_span(void);
+static void test_buff_peek_chunk(void);
+static void test_buff_iter(void);
+#if BUFF_MIRROR_SUPPORT == 1U
+static void test_buff_mirrored(void);
+#endif
+static void test_buff_spsc_mode(void);
+static void test_buff_spsc_threads(void);
+static void test_buff_item_sizes(void);
+static void test_buff_define(void);
+static void test_buff_wait(void);
+static void test_buff_wait_idle(void);
+static void test_buff_watermarks(void);
+static void test_buff_priority(void);
+static void test_buff_iov(void);
+static void test_buff_transaction(void);
+static void test_buff_persistent(void);
+static void test_buff_dma(void);
+#if BUFF_ENABLE_STATS == 1U
+static void test_buff_stats(void);
+#endif
+
+static void *spsc_producer(void *arg);
+static void *wait_producer(void *arg);
+static void *wait_consumer(void *arg);
+static bool counted_wait(void* object, uint32_t timeout);
+static void *txn_producer(void *arg);
+#if BUFF_LOCK_STRATEGY != BUFF_LOCK_NONE
+static void *dma_engine(void *arg);
+#endif
+static void mutex_lock(void* object, bool lock);
+static void watermark_high(void* object, size_t count);
+static void watermark_low(void* object, size_t count);
+static int priority_compare(const void* a, const void* b);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_buff_fifo);
+  RUN_TEST(test_buff_lifo);
+  RUN_TEST(test_buff_overflow);
+  RUN_TEST(test_buff_chunk_wrap);
+  RUN_TEST(test_buff_reserve);
+  RUN_TEST(test_buff_span);
+  RUN_TEST(test_buff_peek_chunk);
+  RUN_TEST(test_buff_iter);
+#if BUFF_MIRROR_SUPPORT == 1U
+  RUN_TEST(test_buff_mirrored);
+#endif
+  RUN_TEST(test_buff_spsc_mode);
+  RUN_TEST(test_buff_spsc_threads);
+  RUN_TEST(test_buff_item_sizes);
+  RUN_TEST(test_buff_define);
+  RUN_TEST(test_buff_wait);
+  RUN_TEST(test_buff_wait_idle);
+  RUN_TEST(test_buff_watermarks);
+  RUN_TEST(test_buff_priority);
+  RUN_TEST(test_buff_iov);
+  RUN_TEST(test_buff_transaction);
+  RUN_TEST(test_buff_persistent);
+  RUN_TEST(test_buff_dma);
+#if BUFF_ENABLE_STATS == 1U
+  RUN_TEST(test_buff_stats);
+#endif
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_buff_fifo(void)
+{
+  /* Power-of-two (masked indexes) and generic sizes */
+  const size_t sizes[] = {BUFFER_SIZE, (BUFFER_SIZE - 1U)};
+  uint32_t     item;
+
+  for (size_t run = 0U; run < ARRAY_SIZE(sizes); run++)
+  {
+    /* Prepare */
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, sizes[run], sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+    TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+
+    /* Run: several laps to cross the wrap point */
+    for (uint32_t idx = 0U; idx < (3U * sizes[run]); idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+      TEST_ASSERT_EQUAL_UINT(1U, buff_get_count(&ctrl));
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&ctrl, &item, 0U));
+      TEST_ASSERT_EQUAL_UINT32(idx, item);
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+      TEST_ASSERT_EQUAL_UINT32(idx, item);
+    }
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop(&ctrl, &item));
+
+    /* Fill up */
+    for (uint32_t idx = 0U; idx < sizes[run]; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+    }
+    TEST_ASSERT_TRUE(buff_is_full(&ctrl));
+    TEST_ASSERT_EQUAL_UINT(0U, buff_get_available(&ctrl));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&ctrl, &item, sizes[run] - 1U));
+    TEST_ASSERT_EQUAL_UINT32(sizes[run] - 1U, item);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_INDEX, buff_peek(&ctrl, &item, sizes[run]));
+  }
+}
+
+static void test_buff_lifo(void)
+{
+  uint32_t item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_LIFO, true));
+
+  /* Run */
+  for (uint32_t idx = 0U; idx < 5U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&ctrl, &item, 1U));
+  TEST_ASSERT_EQUAL_UINT32(3U, item);
+  for (uint32_t idx = 5U; idx > 0U; idx--)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT32(idx - 1U, item);
+  }
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+}
+
+static void test_buff_overflow(void)
+{
+  uint32_t  data[BUFFER_SIZE + 3U];
+  uint32_t  item;
+  size_t    count;
+
+  /* Prepare */
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    data[idx] = idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, true));
+
+  /* Run: only the newest items are kept */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, ARRAY_SIZE(data), &count));
+  TEST_ASSERT_EQUAL_UINT(ARRAY_SIZE(data), count);
+  TEST_ASSERT_TRUE(buff_is_full(&ctrl));
+  for (uint32_t idx = 3U; idx < ARRAY_SIZE(data); idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT32(idx, item);
+  }
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+
+  /* Run: non overflow mode keeps the oldest items */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push_chunk(&ctrl, data, ARRAY_SIZE(data), &count));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, count);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&ctrl, data, ARRAY_SIZE(data), &count));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, count);
+  for (uint32_t idx = 0U; idx < BUFFER_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT32(idx, data[idx]);
+  }
+}
+
+static void test_buff_chunk_wrap(void)
+{
+  uint32_t  data[BUFFER_SIZE];
+  uint32_t  item;
+  size_t    count;
+
+  /* Prepare: move the indexes close to the end of the array */
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    data[idx] = idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 6U, &count));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&ctrl, data, 6U, &count));
+  TEST_ASSERT_EQUAL_UINT(6U, count);
+
+  /* Run: push across the wrap point, then overwrite the two oldest items */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 6U, &count));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 4U, &count));
+  TEST_ASSERT_EQUAL_UINT(4U, count);
+  TEST_ASSERT_TRUE(buff_is_full(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&ctrl, &item, 0U));
+  TEST_ASSERT_EQUAL_UINT32(2U, item);
+
+  /* Run: read across the wrap point */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&ctrl, data, 5U, &count));
+  TEST_ASSERT_EQUAL_UINT(5U, count);
+  TEST_ASSERT_EQUAL_UINT32(2U, data[0]);
+  TEST_ASSERT_EQUAL_UINT32(5U, data[3]);
+  TEST_ASSERT_EQUAL_UINT32(0U, data[4]);
+  TEST_ASSERT_EQUAL_UINT(3U, buff_get_count(&ctrl));
+
+  /* Run: LIFO chunk reads the newest items first */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_LIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 3U, &count));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&ctrl, &data[4], 3U, &count));
+  TEST_ASSERT_EQUAL_UINT32(data[2], data[4]);
+  TEST_ASSERT_EQUAL_UINT32(data[0], data[6]);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop_chunk(&ctrl, data, 3U, &count));
+  TEST_ASSERT_EQUAL_UINT(0U, count);
+}
+
+static void test_buff_reserve(void)
+{
+  uint32_t  *region;
+  uint32_t  item;
+  size_t    size;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+
+  /* Run: write in place, commit less than reserved */
+  size = BUFFER_SIZE;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reserve(&ctrl, (void**)&region, &size));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, size);
+  TEST_ASSERT_EQUAL_PTR(items, region);
+  region[0] = 10U;
+  region[1] = 11U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_commit(&ctrl, BUFFER_SIZE + 1U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_commit(&ctrl, 2U));
+  TEST_ASSERT_EQUAL_UINT(2U, buff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(10U, item);
+
+  /* Run: the region stops at the wrap point and at the free slots */
+  size = BUFFER_SIZE;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reserve(&ctrl, (void**)&region, &size));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE - 2U, size);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_commit(&ctrl, size));
+  size = BUFFER_SIZE;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reserve(&ctrl, (void**)&region, &size));
+  TEST_ASSERT_EQUAL_UINT(1U, size);
+  TEST_ASSERT_EQUAL_PTR(items, region);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_commit(&ctrl, size));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_reserve(&ctrl, (void**)&region, &size));
+  TEST_ASSERT_EQUAL_UINT(0U, size);
+
+  /* Run: overflow mode drops the oldest items overlapping the region */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, true));
+  for (uint32_t idx = 0U; idx < BUFFER_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+  }
+  size = 3U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reserve(&ctrl, (void**)&region, &size));
+  TEST_ASSERT_EQUAL_UINT(3U, size);
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE - 3U, buff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_commit(&ctrl, size));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(3U, item);
+
+  /* Run: LIFO is not supported */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_LIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_reserve(&ctrl, (void**)&region, &size));
+}
+
+static void test_buff_span(void)
+{
+  t_buff_span first;
+  t_buff_span second;
+  uint32_t    data[BUFFER_SIZE];
+
+  /* Prepare: leave the oldest item close to the end of the array */
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    data[idx] = idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_peek_span(&ctrl, &first, &second));
+  TEST_ASSERT_EQUAL_UINT(0U, first.size);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 6U, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_consume(&ctrl, 6U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 5U, NULL));
+
+  /* Run: two spans across the wrap point */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek_span(&ctrl, &first, &second));
+  TEST_ASSERT_EQUAL_PTR(&items[6], first.buff);
+  TEST_ASSERT_EQUAL_UINT(2U, first.size);
+  TEST_ASSERT_EQUAL_PTR(items, second.buff);
+  TEST_ASSERT_EQUAL_UINT(3U, second.size);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(data, first.buff, first.size);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(&data[2], second.buff, second.size);
+
+  /* Run: consume part of the data */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_consume(&ctrl, 6U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_consume(&ctrl, 3U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek_span(&ctrl, &first, NULL));
+  TEST_ASSERT_EQUAL_PTR(&items[1], first.buff);
+  TEST_ASSERT_EQUAL_UINT(2U, first.size);
+  TEST_ASSERT_EQUAL_UINT32(3U, *(uint32_t*)first.buff);
+}
+
+static void test_buff_peek_chunk(void)
+{
+  uint32_t data[BUFFER_SIZE];
+  uint32_t output[BUFFER_SIZE];
+  size_t   count;
+
+  /* Prepare: leave the oldest item close to the end of the array */
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    data[idx] = idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_peek_chunk(&ctrl, output, 0U, BUFFER_SIZE, &count));
+  TEST_ASSERT_EQUAL_UINT(0U, count);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 6U, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_consume(&ctrl, 6U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 5U, NULL));
+
+  /* Run: FIFO order across the wrap point, nothing is popped */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek_chunk(&ctrl, output, 1U, BUFFER_SIZE, &count));
+  TEST_ASSERT_EQUAL_UINT(4U, count);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(&data[1], output, 4U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_INDEX, buff_peek_chunk(&ctrl, output, 5U, 1U, &count));
+  TEST_ASSERT_EQUAL_UINT(5U, buff_get_count(&ctrl));
+
+  /* Validate: LIFO order (newest first) */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_LIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 5U, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek_chunk(&ctrl, output, 1U, 3U, &count));
+  TEST_ASSERT_EQUAL_UINT(3U, count);
+  TEST_ASSERT_EQUAL_UINT32(3U, output[0]);
+  TEST_ASSERT_EQUAL_UINT32(2U, output[1]);
+  TEST_ASSERT_EQUAL_UINT32(1U, output[2]);
+}
+
+static void test_buff_iter(void)
+{
+  t_buff_iter iter;
+  t_buff_span span;
+  uint32_t    data[BUFFER_SIZE + 2U];
+  const void* item;
+  uint32_t    expected;
+
+  /* Prepare: FIFO items across the wrap point */
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    data[idx] = idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 6U, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_consume(&ctrl, 6U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, data, 5U, NULL));
+
+  /* Run: item by item, oldest first */
+  expected = 0U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_begin(&ctrl, &iter));
+  while ((item = buff_iter_next(&iter)) != NULL)
+  {
+    TEST_ASSERT_EQUAL_UINT32(expected++, *(const uint32_t*)item);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_end(&iter));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_iter_end(&iter));
+  TEST_ASSERT_EQUAL_UINT32(5U, expected);
+
+  /* Run: span by span */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_begin(&ctrl, &iter));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_next_span(&iter, &span));
+  TEST_ASSERT_EQUAL_PTR(&items[6], span.buff);
+  TEST_ASSERT_EQUAL_UINT(2U, span.size);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_next_span(&iter, &span));
+  TEST_ASSERT_EQUAL_PTR(items, span.buff);
+  TEST_ASSERT_EQUAL_UINT(3U, span.size);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_iter_next_span(&iter, &span));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_end(&iter));
+  TEST_ASSERT_EQUAL_UINT(5U, buff_get_count(&ctrl));
+
+  /* Validate: LIFO walks newest first (the overflow left the items across the wrap point) */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), (BUFF_OPMODE_R_LIFO | BUFF_OPMODE_W_OVERFLOW), true));
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &data[idx]));
+  }
+  expected = BUFFER_SIZE + 2U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_begin(&ctrl, &iter));
+  while ((item = buff_iter_next(&iter)) != NULL)
+  {
+    TEST_ASSERT_EQUAL_UINT32(--expected, *(const uint32_t*)item);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_end(&iter));
+  TEST_ASSERT_EQUAL_UINT32(2U, expected);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_begin(&ctrl, &iter));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_next_span(&iter, &span));
+  TEST_ASSERT_EQUAL_PTR(items, span.buff);
+  TEST_ASSERT_EQUAL_UINT(2U, span.size);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(&data[BUFFER_SIZE], span.buff, 2U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_next_span(&iter, &span));
+  TEST_ASSERT_EQUAL_PTR(&items[2], span.buff);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(&data[2], span.buff, 6U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_iter_end(&iter));
+}
+
+#if BUFF_MIRROR_SUPPORT == 1U
+static void test_buff_mirrored(void)
+{
+  t_buff      mirror;
+  t_buff_span first;
+  t_buff_span second;
+  uint8_t     data[64];
+  uint8_t     check[64];
+  size_t      size;
+  size_t      step;
+  uint8_t     *region;
+
+  /* Prepare: the size is rounded up to whole pages */
+  for (uint32_t idx = 0U; idx < ARRAY_SIZE(data); idx++)
+  {
+    data[idx] = (uint8_t)idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_mirrored(&mirror, 100U, sizeof(uint8_t), BUFF_OPMODE_R_FIFO));
+  size = buff_get_size(&mirror);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT(100U, size);
+  TEST_ASSERT_TRUE(buff_is_empty(&mirror));
+
+  /* Run: move close to the end of the array, one data chunk at a time */
+  for (size_t left = (size - 10U); left > 0U; left -= step)
+  {
+    step = MIN(left, ARRAY_SIZE(data));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&mirror, data, step, NULL));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&mirror, check, step, NULL));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, check, step);
+  }
+  TEST_ASSERT_TRUE(buff_is_empty(&mirror));
+
+  /* Run: regions crossing the wrap point are contiguous */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&mirror, data, ARRAY_SIZE(data), NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek_span(&mirror, &first, &second));
+  TEST_ASSERT_EQUAL_UINT(ARRAY_SIZE(data), first.size);
+  TEST_ASSERT_EQUAL_UINT(0U, second.size);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, first.buff, ARRAY_SIZE(data));
+  TEST_ASSERT_EQUAL_UINT8(data[10], mirror.buff[0]);
+  size = buff_get_available(&mirror);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reserve(&mirror, (void**)&region, &size));
+  TEST_ASSERT_EQUAL_UINT(buff_get_available(&mirror), size);
+
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_deinit_mirrored(&mirror));
+}
+#endif
+
+static void test_buff_spsc_mode(void)
+{
+  uint32_t item = 0U;
+
+  /* Invalid mode combinations */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_SPSC, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT | BUFF_OPMODE_SPSC, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_LIFO | BUFF_OPMODE_SPSC, true));
+
+  /* Full/empty detection without a usage counter */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO | BUFF_OPMODE_SPSC, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop(&ctrl, &item));
+  for (uint32_t idx = 0U; idx < BUFFER_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+  }
+  TEST_ASSERT_TRUE(buff_is_full(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(0U, item);
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE - 1U, buff_get_count(&ctrl));
+}
+
+static void test_buff_spsc_threads(void)
+{
+  pthread_t producer;
+  uint32_t  item;
+  uint32_t  expected = 0U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO | BUFF_OPMODE_SPSC, true));
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, spsc_producer, NULL));
+
+  /* Run: every item must arrive once and in order */
+  while (expected < SPSC_ITEMS)
+  {
+    if (buff_pop(&ctrl, &item) == EMBLIB32_OK)
+    {
+      TEST_ASSERT_EQUAL_UINT32(expected, item);
+      expected++;
+      continue;
+    }
+    sched_yield();
+  }
+  pthread_join(producer, NULL);
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+}
+
+#if BUFF_ENABLE_STATS == 1U
+static void test_buff_stats(void)
+{
+  t_buff_stats stats;
+  uint32_t     chunk[BUFFER_SIZE + 2U] = {0};
+  uint32_t     item = 0U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+
+  /* Run: 5 pushed, 2 popped, 1 empty pop */
+  for (uint32_t idx = 0U; idx < 5U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&ctrl, chunk, 2U, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_get_stats(&ctrl, &stats));
+  TEST_ASSERT_EQUAL_UINT(5U, stats.peak);
+  TEST_ASSERT_EQUAL_UINT32(5U, stats.pushed);
+  TEST_ASSERT_EQUAL_UINT32(2U, stats.popped);
+  TEST_ASSERT_EQUAL_UINT32(0U, stats.dropped);
+
+  /* Run: overflow rejects (FIFO) and overwrites (overflow mode) are both counted */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push_chunk(&ctrl, chunk, 7U, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_get_stats(&ctrl, &stats));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, stats.peak);
+  TEST_ASSERT_EQUAL_UINT32(2U, stats.dropped);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reset_stats(&ctrl));
+
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, chunk, (BUFFER_SIZE + 2U), NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &item));
+  while (buff_pop(&ctrl, &item) == EMBLIB32_OK)
+  {
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_get_stats(&ctrl, &stats));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, stats.peak);
+  TEST_ASSERT_EQUAL_UINT32(BUFFER_SIZE + 1U, stats.pushed);
+  TEST_ASSERT_EQUAL_UINT32(BUFFER_SIZE, stats.popped);
+  TEST_ASSERT_EQUAL_UINT32(3U, stats.dropped);
+  TEST_ASSERT_EQUAL_UINT32(1U, stats.empty_pops);
+
+  /* Validate: reset restarts the peak from the current occupancy */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_reset_stats(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_get_stats(&ctrl, &stats));
+  TEST_ASSERT_EQUAL_UINT(1U, stats.peak);
+  TEST_ASSERT_EQUAL_UINT32(0U, stats.pushed);
+}
+#endif
+
+static void test_buff_watermarks(void)
+{
+  uint32_t item = 0U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_set_watermarks(&ctrl, 2U, 2U, watermark_high, watermark_low, watermarks));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_set_watermarks(&ctrl, 6U, 2U, watermark_high, watermark_low, watermarks));
+  watermarks[0] = 0U;
+  watermarks[1] = 0U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_flush(&ctrl));
+
+  /* Run: each crossing fires once */
+  for (uint32_t lap = 1U; lap <= 2U; lap++)
+  {
+    for (uint32_t idx = 0U; idx < 7U; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT32((idx < 6U)? (lap - 1U) : lap, watermarks[0]);
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+    }
+    TEST_ASSERT_EQUAL_UINT(lap, watermarks[0]);
+    for (uint32_t idx = 0U; idx < 7U; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT32((idx < 5U)? (lap - 1U) : lap, watermarks[1]);
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+    }
+    TEST_ASSERT_EQUAL_UINT(lap, watermarks[1]);
+  }
+
+  /* Validate: idle flush hands over a partial batch */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_flush(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(3U, watermarks[0]);
+  TEST_ASSERT_EQUAL_UINT(2U, watermarks[1]);
+}
+
+static void test_buff_priority(void)
+{
+  const uint32_t input[BUFFER_SIZE] = {42U, 7U, 19U, 7U, 88U, 1U, 63U, 30U};
+  uint32_t       output[BUFFER_SIZE];
+  uint32_t       item;
+  size_t         count;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_PRIORITY | BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_PRIORITY | BUFF_OPMODE_W_OVERFLOW, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_PRIORITY, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_push(&ctrl, &input[0]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_set_priority(&ctrl, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_set_priority(&ctrl, priority_compare));
+
+  /* Run: items come out sorted, the next one is always on index zero */
+  for (size_t idx = 0U; idx < BUFFER_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &input[idx]));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push(&ctrl, &input[0]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&ctrl, &item, 0U));
+  TEST_ASSERT_EQUAL_UINT32(1U, item);
+  for (uint32_t last = 0U; !buff_is_empty(&ctrl); last = item)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(last, item);
+  }
+  TEST_ASSERT_EQUAL_UINT32(88U, item);
+
+  /* Validate: chunks, interleaved with single operations */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, input, 5U, &count));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(7U, item);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_chunk(&ctrl, &input[5], 3U, &count));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_chunk(&ctrl, output, BUFFER_SIZE, &count));
+  TEST_ASSERT_EQUAL_UINT(7U, count);
+  TEST_ASSERT_EQUAL_UINT32(1U, output[0]);
+  TEST_ASSERT_EQUAL_UINT32(7U, output[1]);
+  TEST_ASSERT_EQUAL_UINT32(19U, output[2]);
+  TEST_ASSERT_EQUAL_UINT32(30U, output[3]);
+  TEST_ASSERT_EQUAL_UINT32(42U, output[4]);
+  TEST_ASSERT_EQUAL_UINT32(63U, output[5]);
+  TEST_ASSERT_EQUAL_UINT32(88U, output[6]);
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+}
+
+static void test_buff_iov(void)
+{
+  uint32_t    header     = 0xA5U;
+  uint32_t    payload[4] = {1U, 2U, 3U, 4U};
+  uint32_t    trailer    = 0x5AU;
+  uint32_t    output[BUFFER_SIZE];
+  t_buff_span packet[3]  = {{&header, 1U}, {payload, 4U}, {&trailer, 1U}};
+  t_buff_span split[2]   = {{output, 2U}, {&output[2], (BUFFER_SIZE - 2U)}};
+  size_t      count;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_push_iov(&ctrl, NULL, 3U));
+
+  /* Run: a packet that doesn't fit is not pushed at all */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_iov(&ctrl, packet, 3U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push_iov(&ctrl, packet, 3U));
+  TEST_ASSERT_EQUAL_UINT(6U, buff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_iov(&ctrl, split, 2U, &count));
+  TEST_ASSERT_EQUAL_UINT(6U, count);
+  TEST_ASSERT_EQUAL_UINT32(0xA5U, output[0]);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(payload, &output[1], 4U);
+  TEST_ASSERT_EQUAL_UINT32(0x5AU, output[5]);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop_iov(&ctrl, split, 2U, &count));
+
+  /* Validate: overflow mode drops the oldest items, across the wrap point */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_iov(&ctrl, packet, 3U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_iov(&ctrl, packet, 3U));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, buff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_iov(&ctrl, split, 2U, &count));
+  TEST_ASSERT_EQUAL_UINT(BUFFER_SIZE, count);
+  TEST_ASSERT_EQUAL_UINT32(4U, output[0]);
+  TEST_ASSERT_EQUAL_UINT32(0x5AU, output[1]);
+  TEST_ASSERT_EQUAL_UINT32(0xA5U, output[2]);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(payload, &output[3], 4U);
+  TEST_ASSERT_EQUAL_UINT32(0x5AU, output[BUFFER_SIZE - 1U]);
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+}
+
+static void test_buff_transaction(void)
+{
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_t       producer;
+  uint32_t        item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_set_lock(&ctrl, mutex_lock, &mutex));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_end(&ctrl));
+  txn_pushed = false;
+
+  /* Run: several operations (and a nested transaction) under one acquisition */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_begin(&ctrl));
+  for (uint32_t idx = 0U; idx < 4U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_begin(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&ctrl, &item, 0U));
+  TEST_ASSERT_EQUAL_UINT32(0U, item);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_end(&ctrl));
+
+  /* Validate: other contexts wait until the outermost buff_end */
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, txn_producer, NULL));
+#if BUFF_LOCK_STRATEGY != BUFF_LOCK_NONE
+  for (uint32_t idx = 0U; idx < 1000U; idx++)
+  {
+    sched_yield();
+  }
+  TEST_ASSERT_FALSE(txn_pushed);
+  TEST_ASSERT_EQUAL_UINT(3U, buff_get_count(&ctrl));
+#endif
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_end(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_end(&ctrl));
+  pthread_join(producer, NULL);
+  TEST_ASSERT_TRUE(txn_pushed);
+  TEST_ASSERT_EQUAL_UINT(4U, buff_get_count(&ctrl));
+  for (uint32_t expected = 1U; expected < 4U; expected++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT32(expected, item);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(100U, item);
+
+  /* Validate: SPSC buffers have no lock to hold */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), (BUFF_OPMODE_R_FIFO | BUFF_OPMODE_SPSC), true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_begin(&ctrl));
+  pthread_mutex_destroy(&mutex);
+}
+
+static void test_buff_persistent(void)
+{
+  t_buff_persist* store;
+  uint32_t        item;
+  bool            recovered;
+
+  /* Prepare: uninitialized region */
+  memset(&region, 0xA5, sizeof(region));
+  TEST_ASSERT_EQUAL_UINT(BUFF_PERSIST_SIZE(BUFFER_SIZE, sizeof(uint32_t)), (offsetof(t_test_region, items) + sizeof(region.items)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init_persistent(&region.store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_PRIORITY, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(&region.store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, &recovered));
+  TEST_ASSERT_FALSE(recovered);
+  TEST_ASSERT_TRUE(buff_is_empty(&region.store.buff));
+  for (uint32_t idx = 0U; idx < 6U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&region.store.buff, &idx));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&region.store.buff, &item));
+
+  /* Run: reset (handlers are lost, the region is kept) */
+  memset(&region.store.buff, 0x5A, offsetof(t_buff, tail));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(&region.store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, &recovered));
+  TEST_ASSERT_TRUE(recovered);
+  TEST_ASSERT_EQUAL_UINT32(1U, region.store.generation);
+  TEST_ASSERT_EQUAL_UINT(5U, buff_get_count(&region.store.buff));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_peek(&region.store.buff, &item, 0U));
+  TEST_ASSERT_EQUAL_UINT32(1U, item);
+
+  /* Validate: a different layout or damaged indexes are not recovered */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(&region.store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, &recovered));
+  TEST_ASSERT_FALSE(recovered);
+  TEST_ASSERT_TRUE(buff_is_empty(&region.store.buff));
+  region.store.buff.tail = (3U * BUFFER_SIZE);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(&region.store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, &recovered));
+  TEST_ASSERT_FALSE(recovered);
+  region.store.generation++;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(&region.store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, &recovered));
+  TEST_ASSERT_FALSE(recovered);
+
+#if BUFF_PERSIST_FILE_SUPPORT == 1U
+  /* Validate: the file store survives the mapping */
+  unlink(PERSIST_PATH);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_persist_map(&store, PERSIST_PATH, BUFFER_SIZE, sizeof(uint32_t)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, &recovered));
+  TEST_ASSERT_FALSE(recovered);
+  for (uint32_t idx = 0U; idx < 3U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&store->buff, &idx));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_persist_unmap(store));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_persist_map(&store, PERSIST_PATH, BUFFER_SIZE, sizeof(uint32_t)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init_persistent(store, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, &recovered));
+  TEST_ASSERT_TRUE(recovered);
+  for (uint32_t idx = 0U; idx < 3U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&store->buff, &item));
+    TEST_ASSERT_EQUAL_UINT32(idx, item);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_persist_unmap(store));
+  unlink(PERSIST_PATH);
+#else
+  (void)store;
+#endif
+}
+
+static void test_buff_dma(void)
+{
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_t       engine;
+  t_buff_span     first;
+  t_buff_span     second;
+  uint32_t        item;
+  size_t          consumed;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), (BUFF_OPMODE_DEFAULT | BUFF_OPMODE_DMA), true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), (BUFF_OPMODE_R_FIFO | BUFF_OPMODE_DMA), true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_sync_producer(&ctrl, (BUFFER_SIZE + 1U)));
+
+  /* Run: the "DMA" writes three items */
+  for (uint32_t idx = 0U; idx < 3U; idx++)
+  {
+    items[idx] = 10U + idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_sync_producer(&ctrl, (BUFFER_SIZE - 3U)));
+  TEST_ASSERT_EQUAL_UINT(3U, buff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(10U, item);
+
+  /* Validate: the DMA wraps and reaches the oldest item (overrun, the newest items are kept) */
+  for (uint32_t idx = 3U; idx < (BUFFER_SIZE + 1U); idx++)
+  {
+    items[idx % BUFFER_SIZE] = 10U + idx;
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_sync_producer(&ctrl, (BUFFER_SIZE - 1U)));
+  TEST_ASSERT_EQUAL_UINT((BUFFER_SIZE - 1U), buff_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(12U, item);
+
+  /* Validate: clearing drops the pending items but follows the DMA position */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_clear(&ctrl));
+  TEST_ASSERT_EQUAL_UINT32(18U, items[0]);
+  items[1] = 19U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_sync_producer(&ctrl, (BUFFER_SIZE - 2U)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT32(19U, item);
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+
+#if BUFF_LOCK_STRATEGY != BUFF_LOCK_NONE
+  /* Run: emulated DMA engine (syncs on half/full transfer), the data is read in place */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, dma_items, DMA_SIZE, sizeof(uint8_t), (BUFF_OPMODE_R_FIFO | BUFF_OPMODE_DMA), true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_set_lock(&ctrl, mutex_lock, &mutex));
+  dma_remaining = DMA_SIZE;
+  dma_consumed  = 0U;
+  dma_overrun   = false;
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&engine, NULL, dma_engine, NULL));
+  for (consumed = 0U; consumed < DMA_ITEMS; )
+  {
+    /* Idle line: pick up the partial transfer (the counter is read while holding the buffer) */
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_begin(&ctrl));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_sync_producer(&ctrl, ATOMIC_LOAD_ACQUIRE(&dma_remaining)));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_end(&ctrl));
+    if (buff_peek_span(&ctrl, &first, &second) != EMBLIB32_OK)
+    {
+      sched_yield();
+      continue;
+    }
+    for (size_t idx = 0U; idx < first.size; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT8((uint8_t)consumed, ((uint8_t*)first.buff)[idx]);
+      consumed++;
+    }
+    for (size_t idx = 0U; idx < second.size; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT8((uint8_t)consumed, ((uint8_t*)second.buff)[idx]);
+      consumed++;
+    }
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_consume(&ctrl, (first.size + second.size)));
+    ATOMIC_STORE_RELEASE(&dma_consumed, consumed);
+  }
+  pthread_join(engine, NULL);
+  TEST_ASSERT_FALSE(dma_overrun);
+  TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+#else
+  (void)engine;
+  (void)first;
+  (void)second;
+  (void)consumed;
+#endif
+  pthread_mutex_destroy(&mutex);
+}
+
+#if BUFF_LOCK_STRATEGY != BUFF_LOCK_NONE
+static void *dma_engine(void *arg)
+{
+  size_t position = 0U;
+
+  for (size_t idx = 0U; idx < DMA_ITEMS; idx++)
+  {
+    /* Flow control for the test only (a real DMA never waits) */
+    while ((idx - ATOMIC_LOAD_ACQUIRE(&dma_consumed)) >= (DMA_SIZE / 2U))
+    {
+      sched_yield();
+    }
+
+    /* Write the item and update the remaining counter (reloaded at the end of the lap) */
+    dma_items[position] = (uint8_t)idx;
+    position = (position + 1U) % DMA_SIZE;
+    ATOMIC_STORE_RELEASE(&dma_remaining, (DMA_SIZE - position));
+
+    /* Half/full transfer interrupts */
+    if ((position == 0U) || (position == (DMA_SIZE / 2U)))
+    {
+      if (buff_sync_producer(&ctrl, (DMA_SIZE - position)) != EMBLIB32_OK)
+      {
+        dma_overrun = true;
+      }
+    }
+  }
+  return arg;
+}
+#endif
+
+static void *txn_producer(void *arg)
+{
+  uint32_t item = 100U;
+
+  buff_push(&ctrl, &item);
+  txn_pushed = true;
+  return arg;
+}
+
+static void mutex_lock(void* object, bool lock)
+{
+  if (lock)
+  {
+    pthread_mutex_lock((pthread_mutex_t*)object);
+  }
+  else
+  {
+    pthread_mutex_unlock((pthread_mutex_t*)object);
+  }
+}
+
+static void *wait_producer(void *arg)
+{
+  for (uint32_t idx = 0U; idx < SPSC_ITEMS; idx++)
+  {
+    buff_push_wait(&ctrl, &idx, RTOS_WAIT_FOREVER);
+  }
+  return arg;
+}
+
+static void *wait_consumer(void *arg)
+{
+  uint32_t item;
+
+  /* Each consumer must get its own item well before the timeout */
+  *(uint32_t*)arg = buff_pop_wait(&ctrl, &item, 1000U);
+  return arg;
+}
+
+static void *spsc_producer(void *arg)
+{
+  for (uint32_t idx = 0U; idx < SPSC_ITEMS; )
+  {
+    if (buff_push(&ctrl, &idx) == EMBLIB32_OK)
+    {
+      idx++;
+      continue;
+    }
+    sched_yield();
+  }
+  return arg;
+}
+
+static void test_buff_item_sizes(void)
+{
+  const size_t sizes[] = {1U, 2U, 3U, 4U, 8U, 12U};
+  uint8_t      storage[BUFFER_SIZE * 12U];
+  uint8_t      item[12U];
+  uint8_t      check[12U];
+
+  for (size_t idx = 0; idx < ARRAY_SIZE(sizes); idx++)
+  {
+    /* Prepare */
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, storage, BUFFER_SIZE, sizes[idx], BUFF_OPMODE_DEFAULT, true));
+
+    /* Run: wrap around several times so every slot is used */
+    for (uint8_t value = 0U; value < (3U * BUFFER_SIZE); value++)
+    {
+      memset(item, value, sizes[idx]);
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, item));
+    }
+
+    /* Validate: only the newest items are kept, each one copied whole */
+    for (uint8_t value = (2U * BUFFER_SIZE); value < (3U * BUFFER_SIZE); value++)
+    {
+      memset(check, value, sizes[idx]);
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, item));
+      TEST_ASSERT_EQUAL_MEMORY(check, item, sizes[idx]);
+    }
+    TEST_ASSERT_TRUE(buff_is_empty(&ctrl));
+  }
+}
+
+static void test_buff_define(void)
+{
+  t_typed_odd  odd;
+  t_typed_pow2 pow2;
+  uint16_t     value;
+  uint64_t     wide;
+
+  /* Prepare */
+  typed_odd_init(&odd);
+  typed_pow2_init(&pow2);
+  TEST_ASSERT_TRUE(typed_odd_is_empty(&odd));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, typed_odd_pop(&odd, &value));
+
+  /* Run: several laps over both index schemes (compare/subtract and mask) */
+  for (uint16_t lap = 0U; lap < 4U; lap++)
+  {
+    for (uint16_t idx = 0U; idx < 5U; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, typed_odd_push(&odd, (uint16_t)((lap * 5U) + idx)));
+    }
+    TEST_ASSERT_TRUE(typed_odd_is_full(&odd));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, typed_odd_push(&odd, 0U));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, typed_odd_peek(&odd, &value));
+    TEST_ASSERT_EQUAL_UINT16((lap * 5U), value);
+    for (uint16_t idx = 0U; idx < 5U; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, typed_odd_pop(&odd, &value));
+      TEST_ASSERT_EQUAL_UINT16(((lap * 5U) + idx), value);
+    }
+
+    for (uint64_t idx = 0U; idx < 3U; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, typed_pow2_push(&pow2, ((uint64_t)lap << 40) | idx));
+    }
+    TEST_ASSERT_EQUAL_UINT(3U, typed_pow2_get_count(&pow2));
+    for (uint64_t idx = 0U; idx < 3U; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, typed_pow2_pop(&pow2, &wide));
+      TEST_ASSERT_TRUE(wide == (((uint64_t)lap << 40) | idx));
+    }
+  }
+  TEST_ASSERT_TRUE(typed_odd_is_empty(&odd));
+  TEST_ASSERT_TRUE(typed_pow2_is_empty(&pow2));
+}
+
+static void test_buff_wait(void)
+{
+  pthread_t producer;
+  pthread_t consumers[2];
+  uint32_t  status[2];
+  uint32_t  item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, rtos_event_init(&data_event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, rtos_event_init(&space_event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, buff_pop_wait(&ctrl, &item, 0U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_set_notify(&ctrl, rtos_event_wait, rtos_event_notify, &data_event, &space_event));
+
+  /* Validate: timeouts are deadlines */
+  TEST_ASSERT_EQUAL_UINT32(RTOS_WAIT_FOREVER, rtos_get_remaining(0U, RTOS_WAIT_FOREVER));
+  TEST_ASSERT_EQUAL_UINT32(0U, rtos_get_remaining((rtos_get_time() - 20U), 10U));
+  TEST_ASSERT_UINT32_WITHIN(10U, 1000U, rtos_get_remaining(rtos_get_time(), 1000U));
+
+  /* Validate: timeouts on an empty buffer */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop_wait(&ctrl, &item, 0U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop_wait(&ctrl, &item, 10U));
+
+  /* Run: the producer blocks while the buffer is full, the consumer while it is empty */
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, wait_producer, NULL));
+  for (uint32_t expected = 0U; expected < SPSC_ITEMS; expected++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop_wait(&ctrl, &item, RTOS_WAIT_FOREVER));
+    TEST_ASSERT_EQUAL_UINT32(expected, item);
+  }
+  pthread_join(producer, NULL);
+
+  /* Validate: timeouts on a full buffer */
+  for (uint32_t idx = 0U; idx < BUFFER_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push_wait(&ctrl, &idx, 0U));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push_wait(&ctrl, &item, 10U));
+
+  /* Validate: notifications are counted, each one releases a single wait */
+  while (rtos_event_wait(&data_event, 0U))
+  {
+  }
+  rtos_event_notify(&data_event);
+  rtos_event_notify(&data_event);
+  TEST_ASSERT_TRUE(rtos_event_wait(&data_event, 0U));
+  TEST_ASSERT_TRUE(rtos_event_wait(&data_event, 0U));
+  TEST_ASSERT_FALSE(rtos_event_wait(&data_event, 0U));
+
+  /* Run: two consumers wait on the same event, two pushes wake up both */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_clear(&ctrl));
+  for (size_t idx = 0U; idx < ARRAY_SIZE(consumers); idx++)
+  {
+    status[idx] = EMBLIB32_ERROR_PARAMETER;
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&consumers[idx], NULL, wait_consumer, &status[idx]));
+  }
+  usleep(10000U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &item));
+  for (size_t idx = 0U; idx < ARRAY_SIZE(consumers); idx++)
+  {
+    pthread_join(consumers[idx], NULL);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, status[idx]);
+  }
+  rtos_event_deinit(&data_event);
+  rtos_event_deinit(&space_event);
+}
+
+static void test_buff_wait_idle(void)
+{
+  uint32_t item = 0U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, rtos_event_init(&data_event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, rtos_event_init(&space_event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ctrl, items, BUFFER_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_set_notify(&ctrl, counted_wait, rtos_event_notify, &data_event, &space_event));
+
+  /* Run: heavy traffic with nobody waiting */
+  for (uint32_t idx = 0U; idx < 100000U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&ctrl, &item));
+  }
+
+  /* Validate: no notification was left behind, the waits block once until the deadline */
+  TEST_ASSERT_FALSE(rtos_event_wait(&data_event, 0U));
+  TEST_ASSERT_FALSE(rtos_event_wait(&space_event, 0U));
+  wait_calls = 0U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, buff_pop_wait(&ctrl, &item, 20U));
+  TEST_ASSERT_EQUAL_UINT(1U, wait_calls);
+
+  for (uint32_t idx = 0U; idx < BUFFER_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&ctrl, &idx));
+  }
+  wait_calls = 0U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, buff_push_wait(&ctrl, &item, 20U));
+  TEST_ASSERT_EQUAL_UINT(1U, wait_calls);
+  TEST_ASSERT_EQUAL_UINT(0U, ctrl.data_waiters);
+  TEST_ASSERT_EQUAL_UINT(0U, ctrl.space_waiters);
+  rtos_event_deinit(&data_event);
+  rtos_event_deinit(&space_event);
+}
+
+static bool counted_wait(void* object, uint32_t timeout)
+{
+  wait_calls++;
+  return rtos_event_wait(object, timeout);
+}
+
+static void watermark_high(void* object, size_t count)
+{
+  TEST_ASSERT_GREATER_THAN_UINT(0U, count);
+  ((size_t*)object)[0]++;
+}
+
+static void watermark_low(void* object, size_t count)
+{
+  TEST_ASSERT_LESS_OR_EQUAL_UINT(2U, count);
+  ((size_t*)object)[1]++;
+}
+
+static int priority_compare(const void* a, const void* b)
+{
+  uint32_t lhs = *(const uint32_t*)a;
+  uint32_t rhs = *(const uint32_t*)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Buffer -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,364 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_latest.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Latest-value exchange testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "emblib32_core.h"
+#include "emblib32_latest.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Latest
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define READERS           3U
+#define THREAD_ITEMS      200000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Test item: the sequence is repeated so torn reads can be detected */
+typedef struct
+{
+  uint32_t  seq[16];
+} t_test_item;
+
+/** Reader results */
+typedef struct
+{
+  uint32_t  reads;              /*!< Successful reads */
+  bool      ordered;            /*!< Values never went backwards */
+  bool      consistent;         /*!< No torn value was received */
+} t_test_result;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_triple          triple;
+uint8_t           triple_buff[TRIPLE_STORAGE_SIZE(sizeof(t_test_item))];
+t_seqlock         seqlock;
+uint8_t           seqlock_buff[SEQLOCK_STORAGE_SIZE(sizeof(t_test_item))];
+t_test_result     results[READERS];
+volatile bool     writing;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_triple_single(void);
+static void test_triple_threads(void);
+static void test_seqlock_single(void);
+static void test_seqlock_threads(void);
+
+static void test_item_fill(t_test_item* item, uint32_t seq);
+static void test_item_check(t_test_result* result, const t_test_item* item, uint32_t* last);
+static void *triple_writer(void *arg);
+static void *triple_reader(void *arg);
+static void *seqlock_writer(void *arg);
+static void *seqlock_reader(void *arg);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_triple_single);
+  RUN_TEST(test_triple_threads);
+  RUN_TEST(test_seqlock_single);
+  RUN_TEST(test_seqlock_threads);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_triple_single(void)
+{
+  t_test_item item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, triple_init(&triple, triple_buff, 0U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_init(&triple, triple_buff, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, triple_read(&triple, &item));
+  TEST_ASSERT_FALSE(triple_is_fresh(&triple));
+
+  /* Run: only the latest value is kept */
+  for (uint32_t seq = 1U; seq <= 3U; seq++)
+  {
+    test_item_fill(&item, seq);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_write(&triple, &item));
+  }
+  TEST_ASSERT_TRUE(triple_is_fresh(&triple));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_read(&triple, &item));
+  TEST_ASSERT_EQUAL_UINT32(3U, item.seq[0]);
+
+  /* Validate: the value stays until a new one is published */
+  TEST_ASSERT_FALSE(triple_is_fresh(&triple));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_read(&triple, &item));
+  TEST_ASSERT_EQUAL_UINT32(3U, item.seq[0]);
+  test_item_fill(&item, 4U);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_write(&triple, &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_read(&triple, &item));
+  TEST_ASSERT_EQUAL_UINT32(4U, item.seq[15]);
+}
+
+static void test_triple_threads(void)
+{
+  pthread_t writer;
+  pthread_t reader;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, triple_init(&triple, triple_buff, sizeof(t_test_item)));
+  memset(results, 0, sizeof(results));
+  writing = true;
+
+  /* Run */
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&reader, NULL, triple_reader, NULL));
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, triple_writer, NULL));
+  pthread_join(writer, NULL);
+  pthread_join(reader, NULL);
+
+  /* Validate */
+  TEST_ASSERT_TRUE(results[0].ordered);
+  TEST_ASSERT_TRUE(results[0].consistent);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, results[0].reads);
+}
+
+static void test_seqlock_single(void)
+{
+  t_test_item item;
+  uint32_t    version;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, seqlock_init(&seqlock, NULL, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, seqlock_init(&seqlock, seqlock_buff, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, seqlock_read(&seqlock, &item, NULL));
+
+  /* Run */
+  for (uint32_t seq = 1U; seq <= 3U; seq++)
+  {
+    test_item_fill(&item, seq);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, seqlock_write(&seqlock, &item));
+    memset(&item, 0, sizeof(item));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, seqlock_read(&seqlock, &item, &version));
+
+    /* Validate */
+    TEST_ASSERT_EQUAL_UINT32(seq, item.seq[0]);
+    TEST_ASSERT_EQUAL_UINT32(seq, item.seq[15]);
+    TEST_ASSERT_EQUAL_UINT32(seq, version);
+  }
+}
+
+static void test_seqlock_threads(void)
+{
+  pthread_t writer;
+  pthread_t readers[READERS];
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, seqlock_init(&seqlock, seqlock_buff, sizeof(t_test_item)));
+  memset(results, 0, sizeof(results));
+  writing = true;
+
+  /* Run */
+  for (uintptr_t idx = 0U; idx < READERS; idx++)
+  {
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&readers[idx], NULL, seqlock_reader, (void*)idx));
+  }
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, seqlock_writer, NULL));
+  pthread_join(writer, NULL);
+  for (size_t idx = 0U; idx < READERS; idx++)
+  {
+    pthread_join(readers[idx], NULL);
+  }
+
+  /* Validate */
+  for (size_t idx = 0U; idx < READERS; idx++)
+  {
+    TEST_ASSERT_TRUE(results[idx].ordered);
+    TEST_ASSERT_TRUE(results[idx].consistent);
+    TEST_ASSERT_GREATER_THAN_UINT32(0U, results[idx].reads);
+  }
+}
+
+static void test_item_fill(t_test_item* item, uint32_t seq)
+{
+  for (size_t idx = 0U; idx < ARRAY_SIZE(item->seq); idx++)
+  {
+    item->seq[idx] = seq;
+  }
+}
+
+static void test_item_check(t_test_result* result, const t_test_item* item, uint32_t* last)
+{
+  for (size_t idx = 1U; idx < ARRAY_SIZE(item->seq); idx++)
+  {
+    if (item->seq[idx] != item->seq[0])
+    {
+      result->consistent = false;
+    }
+  }
+  if (item->seq[0] < *last)
+  {
+    result->ordered = false;
+  }
+  *last = item->seq[0];
+  result->reads++;
+}
+
+static void *triple_writer(void *arg)
+{
+  t_test_item item;
+
+  UNUSED(arg);
+  for (uint32_t seq = 1U; seq <= THREAD_ITEMS; seq++)
+  {
+    test_item_fill(&item, seq);
+    triple_write(&triple, &item);
+  }
+  ATOMIC_STORE_RELEASE(&writing, false);
+  return NULL;
+}
+
+static void *triple_reader(void *arg)
+{
+  t_test_result* result = &results[0];
+  uint32_t       last   = 0U;
+  t_test_item    item;
+
+  UNUSED(arg);
+  result->ordered    = true;
+  result->consistent = true;
+  while (ATOMIC_LOAD_ACQUIRE(&writing) || (last < THREAD_ITEMS))
+  {
+    if (triple_read(&triple, &item) == EMBLIB32_OK)
+    {
+      test_item_check(result, &item, &last);
+    }
+  }
+  return NULL;
+}
+
+static void *seqlock_writer(void *arg)
+{
+  t_test_item item;
+
+  UNUSED(arg);
+  for (uint32_t seq = 1U; seq <= THREAD_ITEMS; seq++)
+  {
+    test_item_fill(&item, seq);
+    seqlock_write(&seqlock, &item);
+  }
+  ATOMIC_STORE_RELEASE(&writing, false);
+  return NULL;
+}
+
+static void *seqlock_reader(void *arg)
+{
+  t_test_result* result = &results[(uintptr_t)arg];
+  uint32_t       last   = 0U;
+  uint32_t       version;
+  t_test_item    item;
+
+  result->ordered    = true;
+  result->consistent = true;
+  while (ATOMIC_LOAD_ACQUIRE(&writing) || (last < THREAD_ITEMS))
+  {
+    if (seqlock_read(&seqlock, &item, &version) == EMBLIB32_OK)
+    {
+      if (version != item.seq[0])
+      {
+        result->consistent = false;
+      }
+      test_item_check(result, &item, &last);
+    }
+  }
+  return NULL;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Latest -->
+*//*--------------------------------------------------------------------------*/
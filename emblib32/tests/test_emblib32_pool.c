@@ -0,0 +1,304 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_pool.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Block pool testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "emblib32_core.h"
+#include "emblib32_pool.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Pool
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define BLOCK_COUNT       8U
+#define QUEUE_SIZE        4U
+#define THREAD_ITEMS      20000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Sensor record (large item) */
+typedef struct
+{
+  uint32_t        seq;
+  uint8_t         data[252];
+} t_test_record;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_pool            ctrl;
+t_buff            free_list;
+t_buff            queue;
+size_t            blocks[POOL_STORAGE_SIZE(BLOCK_COUNT, sizeof(t_test_record)) / sizeof(size_t)];
+void*             free_storage[BLOCK_COUNT];
+void*             queue_storage[QUEUE_SIZE];
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_pool_init(void);
+static void test_pool_ownership(void);
+static void test_pool_threads(void);
+
+static void test_pool_setup(uint16_t mode);
+static void *pool_producer(void *arg);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_pool_init);
+  RUN_TEST(test_pool_ownership);
+  RUN_TEST(test_pool_threads);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_pool_init(void)
+{
+  void* block;
+
+  /* Validate: the free list must hold every block pointer */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&free_list, free_storage, BLOCK_COUNT, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, pool_init(&ctrl, blocks, BLOCK_COUNT, sizeof(t_test_record), &free_list));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&free_list, free_storage, (BLOCK_COUNT - 1U), sizeof(void*), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, pool_init(&ctrl, blocks, BLOCK_COUNT, sizeof(t_test_record), &free_list));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&free_list, free_storage, BLOCK_COUNT, sizeof(void*), BUFF_OPMODE_DEFAULT, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, pool_init(&ctrl, blocks, BLOCK_COUNT, sizeof(t_test_record), &free_list));
+
+  /* Run: take every block */
+  test_pool_setup(BUFF_OPMODE_R_FIFO);
+  TEST_ASSERT_EQUAL_UINT(0U, pool_get_used(&ctrl));
+  for (size_t idx = 0U; idx < BLOCK_COUNT; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_alloc(&ctrl, &block));
+    TEST_ASSERT_EQUAL_UINT(0U, ((uintptr_t)block % sizeof(size_t)));
+    memset(block, 0xA5, sizeof(t_test_record));
+  }
+
+  /* Validate: the pool runs dry, the blocks don't overlap the headers */
+  TEST_ASSERT_EQUAL_UINT(BLOCK_COUNT, pool_get_used(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_EMPTY, pool_alloc(&ctrl, &block));
+  TEST_ASSERT_NULL(block);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_LEAK, pool_deinit(&ctrl, NULL));
+}
+
+static void test_pool_ownership(void)
+{
+  t_test_record* record;
+  void*          block;
+  void*          other;
+  size_t         leaked;
+
+  /* Prepare */
+  test_pool_setup(BUFF_OPMODE_R_FIFO);
+
+  /* Run: the producer fills a record and sends it, the queue copies the pointer only */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_alloc(&ctrl, &block));
+  record      = (t_test_record*)block;
+  record->seq = 0x1234U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_send(&ctrl, &queue, block));
+  TEST_ASSERT_EQUAL_UINT(1U, buff_get_count(&queue));
+  TEST_ASSERT_EQUAL_UINT(1U, pool_get_used(&ctrl));
+
+  /* Validate: the consumer gets the same block */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_receive(&ctrl, &queue, &other));
+  TEST_ASSERT_EQUAL_PTR(block, other);
+  TEST_ASSERT_EQUAL_UINT32(0x1234U, ((t_test_record*)other)->seq);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, pool_receive(&ctrl, &queue, &other));
+
+  /* Validate: foreign and misaligned pointers are never accepted */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_free(&ctrl, &leaked));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_free(&ctrl, ((uint8_t*)block + 1U)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_send(&ctrl, &queue, &leaked));
+
+  /* Run: the consumer gives the block back */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_free(&ctrl, block));
+  TEST_ASSERT_EQUAL_UINT(0U, pool_get_used(&ctrl));
+#if POOL_DEBUG == 1U
+  /* Validate: double free and freeing a queued block are detected */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_free(&ctrl, block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_send(&ctrl, &queue, block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_alloc(&ctrl, &block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_send(&ctrl, &queue, block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_free(&ctrl, block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_receive(&ctrl, &queue, &block));
+
+  /* Validate: raw pointers pushed behind the pool back are reported */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&queue, &block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_OWNERSHIP, pool_receive(&ctrl, &queue, &other));
+  TEST_ASSERT_EQUAL_PTR(block, other);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_free(&ctrl, block));
+#endif
+
+  /* Validate: a full queue leaves the block with the sender */
+  for (size_t idx = 0U; idx < QUEUE_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_alloc(&ctrl, &block));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_send(&ctrl, &queue, block));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_alloc(&ctrl, &block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, pool_send(&ctrl, &queue, block));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_free(&ctrl, block));
+
+  /* Validate: queued blocks are leaks until received and freed */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_POOL_LEAK, pool_deinit(&ctrl, &leaked));
+  TEST_ASSERT_EQUAL_UINT(QUEUE_SIZE, leaked);
+  test_pool_setup(BUFF_OPMODE_R_FIFO);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_deinit(&ctrl, &leaked));
+  TEST_ASSERT_EQUAL_UINT(0U, leaked);
+}
+
+static void test_pool_threads(void)
+{
+  pthread_t      producer;
+  t_test_record* record;
+  void*          block;
+  uint32_t       expected = 0U;
+
+  /* Prepare: one producer allocates, one consumer frees. No locks */
+  test_pool_setup(BUFF_OPMODE_R_FIFO | BUFF_OPMODE_SPSC);
+
+  /* Run: receive every record in order and hand it back */
+  pthread_create(&producer, NULL, pool_producer, NULL);
+  while (expected < THREAD_ITEMS)
+  {
+    if (pool_receive(&ctrl, &queue, &block) != EMBLIB32_OK)
+    {
+      sched_yield();
+      continue;
+    }
+    record = (t_test_record*)block;
+    TEST_ASSERT_EQUAL_UINT32(expected, record->seq);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)expected, record->data[sizeof(record->data) - 1U]);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_free(&ctrl, block));
+    expected++;
+  }
+  pthread_join(producer, NULL);
+
+  /* Validate */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_deinit(&ctrl, NULL));
+}
+
+static void test_pool_setup(uint16_t mode)
+{
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&free_list, free_storage, BLOCK_COUNT, sizeof(void*), mode, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&queue, queue_storage, QUEUE_SIZE, sizeof(void*), mode, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, pool_init(&ctrl, blocks, BLOCK_COUNT, sizeof(t_test_record), &free_list));
+}
+
+static void *pool_producer(void *arg)
+{
+  t_test_record* record;
+  void*          block;
+
+  for (uint32_t idx = 0U; idx < THREAD_ITEMS; )
+  {
+    if (pool_alloc(&ctrl, &block) != EMBLIB32_OK)
+    {
+      sched_yield();
+      continue;
+    }
+    record      = (t_test_record*)block;
+    record->seq = idx;
+    memset(record->data, (uint8_t)idx, sizeof(record->data));
+    while (pool_send(&ctrl, &queue, block) != EMBLIB32_OK)
+    {
+      sched_yield();
+    }
+    idx++;
+  }
+  return arg;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Pool -->
+*//*--------------------------------------------------------------------------*/
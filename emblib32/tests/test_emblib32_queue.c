@@ -0,0 +1,278 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_queue.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Lock-free MPMC queue testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "emblib32_core.h"
+#include "emblib32_queue.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Queue
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define QUEUE_SIZE        16U
+#define THREADS           4U
+#define THREAD_ITEMS      50000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Test item: producer ID and per-producer sequence */
+typedef struct
+{
+  uint32_t  producer;
+  uint32_t  seq;
+} t_test_item;
+
+/** Consumer results */
+typedef struct
+{
+  uint32_t  count[THREADS];     /*!< Items received from each producer */
+  uint32_t  last[THREADS];      /*!< Last sequence received from each producer (+1) */
+  uint64_t  sum;                /*!< Sum of all the sequences received */
+  bool      ordered;            /*!< Items from a producer arrived in order */
+} t_test_result;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_queue         ctrl;
+size_t          slots[QUEUE_STORAGE_SIZE(QUEUE_SIZE, sizeof(t_test_item)) / sizeof(size_t)];
+t_test_result   results[THREADS];
+volatile size_t consumed;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_queue_init(void);
+static void test_queue_single(void);
+static void test_queue_threads(void);
+
+static void *queue_producer(void *arg);
+static void *queue_consumer(void *arg);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_queue_init);
+  RUN_TEST(test_queue_single);
+  RUN_TEST(test_queue_threads);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_queue_init(void)
+{
+  /* Sizes must be a power of two */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, queue_init(&ctrl, slots, 0U, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, queue_init(&ctrl, slots, 12U, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, queue_init(&ctrl, slots, QUEUE_SIZE, 0U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, queue_init(&ctrl, slots, QUEUE_SIZE, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(QUEUE_SIZE, queue_get_size(&ctrl));
+  TEST_ASSERT_TRUE(queue_is_empty(&ctrl));
+}
+
+static void test_queue_single(void)
+{
+  t_test_item item = {0};
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, queue_init(&ctrl, slots, QUEUE_SIZE, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, queue_pop(&ctrl, &item));
+
+  /* Run: several laps, filling up the queue each time */
+  for (uint32_t lap = 0U; lap < 3U; lap++)
+  {
+    for (uint32_t idx = 0U; idx < QUEUE_SIZE; idx++)
+    {
+      item.seq = (lap * QUEUE_SIZE) + idx;
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, queue_push(&ctrl, &item));
+    }
+    TEST_ASSERT_EQUAL_UINT(QUEUE_SIZE, queue_get_count(&ctrl));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_OVERFLOW, queue_push(&ctrl, &item));
+    for (uint32_t idx = 0U; idx < QUEUE_SIZE; idx++)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, queue_pop(&ctrl, &item));
+      TEST_ASSERT_EQUAL_UINT32((lap * QUEUE_SIZE) + idx, item.seq);
+    }
+    TEST_ASSERT_TRUE(queue_is_empty(&ctrl));
+  }
+}
+
+static void test_queue_threads(void)
+{
+  pthread_t producers[THREADS];
+  pthread_t consumers[THREADS];
+  uint64_t  sum = 0U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, queue_init(&ctrl, slots, QUEUE_SIZE, sizeof(t_test_item)));
+  memset(results, 0, sizeof(results));
+  consumed = 0U;
+
+  /* Run */
+  for (uintptr_t idx = 0U; idx < THREADS; idx++)
+  {
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&consumers[idx], NULL, queue_consumer, (void*)idx));
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&producers[idx], NULL, queue_producer, (void*)idx));
+  }
+  for (size_t idx = 0U; idx < THREADS; idx++)
+  {
+    pthread_join(producers[idx], NULL);
+    pthread_join(consumers[idx], NULL);
+  }
+
+  /* Validate: every item arrived exactly once, in order for each producer/consumer pair */
+  for (size_t producer = 0U; producer < THREADS; producer++)
+  {
+    uint32_t count = 0U;
+    for (size_t consumer = 0U; consumer < THREADS; consumer++)
+    {
+      count += results[consumer].count[producer];
+    }
+    TEST_ASSERT_EQUAL_UINT32(THREAD_ITEMS, count);
+  }
+  for (size_t consumer = 0U; consumer < THREADS; consumer++)
+  {
+    TEST_ASSERT_TRUE(results[consumer].ordered);
+    sum += results[consumer].sum;
+  }
+  TEST_ASSERT_EQUAL_UINT64((uint64_t)THREADS * ((uint64_t)THREAD_ITEMS * (THREAD_ITEMS - 1U) / 2U), sum);
+  TEST_ASSERT_TRUE(queue_is_empty(&ctrl));
+}
+
+static void *queue_producer(void *arg)
+{
+  t_test_item item;
+
+  item.producer = (uint32_t)(uintptr_t)arg;
+  for (item.seq = 0U; item.seq < THREAD_ITEMS; )
+  {
+    if (queue_push(&ctrl, &item) == EMBLIB32_OK)
+    {
+      item.seq++;
+      continue;
+    }
+    sched_yield();
+  }
+  return NULL;
+}
+
+static void *queue_consumer(void *arg)
+{
+  t_test_result *result = &results[(uintptr_t)arg];
+  t_test_item   item;
+
+  result->ordered = true;
+  while (ATOMIC_LOAD_RELAXED(&consumed) < (THREADS * THREAD_ITEMS))
+  {
+    if (queue_pop(&ctrl, &item) != EMBLIB32_OK)
+    {
+      sched_yield();
+      continue;
+    }
+    __atomic_fetch_add(&consumed, 1U, __ATOMIC_RELAXED);
+    if (item.seq < result->last[item.producer])
+    {
+      result->ordered = false;
+    }
+    result->last[item.producer] = item.seq + 1U;
+    result->count[item.producer]++;
+    result->sum += item.seq;
+  }
+  return NULL;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Queue -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,296 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_select.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Buffer set testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+
+#include "emblib32_core.h"
+#include "emblib32_select.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Select
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define QUEUES            4U
+#define QUEUE_SIZE        8U
+#define THREAD_ITEMS      20000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_select          ctrl;
+t_select_member   members[QUEUES];
+t_rtos_event      event;
+t_buff            queues[QUEUES];
+uint32_t          storage[QUEUES][QUEUE_SIZE];
+size_t            wait_calls;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_select_init(void);
+static void test_select_events(void);
+static void test_select_threads(void);
+static void test_select_idle(void);
+
+static void test_queues_init(uint16_t mode);
+static void *select_producer(void *arg);
+static bool counted_wait(void* object, uint32_t timeout);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_select_init);
+  RUN_TEST(test_select_events);
+  RUN_TEST(test_select_threads);
+  RUN_TEST(test_select_idle);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  rtos_event_init(&event);
+}
+
+void tearDown(void)
+{
+  rtos_event_deinit(&event);
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_select_init(void)
+{
+  /* Prepare */
+  test_queues_init(BUFF_OPMODE_R_FIFO);
+
+  /* Validate: set limits and event masks */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, select_init(&ctrl, members, (SELECT_MAX_MEMBERS + 1U), rtos_event_wait, rtos_event_notify, &event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, select_init(&ctrl, members, 2U, rtos_event_wait, NULL, &event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_init(&ctrl, members, 2U, rtos_event_wait, rtos_event_notify, &event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, select_add(&ctrl, &queues[0], 0U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, select_add(&ctrl, &queues[0], 0x04U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[0], SELECT_READABLE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[1], SELECT_READABLE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, select_add(&ctrl, &queues[2], SELECT_READABLE));
+  TEST_ASSERT_EQUAL_UINT(0U, select_poll(&ctrl));
+}
+
+static void test_select_events(void)
+{
+  uint32_t ready;
+  uint32_t item = 0U;
+
+  /* Prepare: two readers and a writer */
+  test_queues_init(BUFF_OPMODE_R_FIFO);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_init(&ctrl, members, QUEUES, rtos_event_wait, rtos_event_notify, &event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[0], SELECT_READABLE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[1], SELECT_READABLE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[2], SELECT_WRITABLE));
+  for (uint32_t idx = 0U; idx < QUEUE_SIZE; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&queues[2], &idx));
+  }
+
+  /* Validate: nothing ready, the wait times out */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_SELECT_TIMEOUT, select_wait(&ctrl, 0U, &ready));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_SELECT_TIMEOUT, select_wait(&ctrl, 10U, &ready));
+  TEST_ASSERT_EQUAL_UINT32(0U, ready);
+
+  /* Run: each member reports its own bit */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&queues[1], &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_wait(&ctrl, RTOS_WAIT_FOREVER, &ready));
+  TEST_ASSERT_EQUAL_UINT32(0x02U, ready);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&queues[2], &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_wait(&ctrl, 0U, &ready));
+  TEST_ASSERT_EQUAL_UINT32(0x06U, ready);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&queues[1], &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&queues[2], &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_SELECT_TIMEOUT, select_wait(&ctrl, 10U, &ready));
+}
+
+static void test_select_threads(void)
+{
+  pthread_t producer;
+  uint32_t  next[QUEUES] = {0U, 1U, 2U, 3U};
+  uint32_t  received     = 0U;
+  uint32_t  ready;
+  uint32_t  item;
+
+  /* Prepare */
+  test_queues_init(BUFF_OPMODE_R_FIFO | BUFF_OPMODE_SPSC);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_init(&ctrl, members, QUEUES, rtos_event_wait, rtos_event_notify, &event));
+  for (size_t idx = 0U; idx < QUEUES; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[idx], SELECT_READABLE));
+  }
+
+  /* Run: drain whichever queue is ready, the items of every queue must arrive in order */
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, select_producer, NULL));
+  while (received < THREAD_ITEMS)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_wait(&ctrl, 1000U, &ready));
+    for (size_t idx = 0U; idx < QUEUES; idx++)
+    {
+      while ((ready & (1UL << idx)) && (buff_pop(&queues[idx], &item) == EMBLIB32_OK))
+      {
+        TEST_ASSERT_EQUAL_UINT32(next[idx], item);
+        next[idx] += QUEUES;
+        received++;
+      }
+    }
+  }
+  pthread_join(producer, NULL);
+
+  /* Validate */
+  TEST_ASSERT_EQUAL_UINT32(THREAD_ITEMS, received);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_SELECT_TIMEOUT, select_wait(&ctrl, 0U, &ready));
+}
+
+static void test_select_idle(void)
+{
+  uint32_t ready;
+  uint32_t item = 0U;
+
+  /* Prepare */
+  test_queues_init(BUFF_OPMODE_R_FIFO);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_init(&ctrl, members, 2U, counted_wait, rtos_event_notify, &event));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[0], SELECT_READABLE));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_add(&ctrl, &queues[1], SELECT_READABLE));
+
+  /* Run: heavy traffic on a member while nobody waits on the set */
+  for (uint32_t idx = 0U; idx < 50000U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&queues[0], &idx));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&queues[0], &item));
+  }
+
+  /* Validate: no notification was left behind, the wait blocks once until the deadline */
+  TEST_ASSERT_FALSE(rtos_event_wait(&event, 0U));
+  wait_calls = 0U;
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_SELECT_TIMEOUT, select_wait(&ctrl, 20U, &ready));
+  TEST_ASSERT_EQUAL_UINT(1U, wait_calls);
+  TEST_ASSERT_EQUAL_UINT32(0U, ready);
+
+  /* Validate: the registrations are dropped once the wait returns */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_push(&queues[1], &item));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, select_wait(&ctrl, 0U, &ready));
+  TEST_ASSERT_EQUAL_UINT32(0x02U, ready);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_pop(&queues[1], &item));
+  TEST_ASSERT_EQUAL_UINT(0U, queues[0].data_waiters);
+  TEST_ASSERT_EQUAL_UINT(0U, queues[1].data_waiters);
+  TEST_ASSERT_FALSE(rtos_event_wait(&event, 0U));
+}
+
+static void test_queues_init(uint16_t mode)
+{
+  for (size_t idx = 0U; idx < QUEUES; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&queues[idx], storage[idx], QUEUE_SIZE, sizeof(uint32_t), mode, true));
+  }
+}
+
+static bool counted_wait(void* object, uint32_t timeout)
+{
+  wait_calls++;
+  return rtos_event_wait(object, timeout);
+}
+
+static void *select_producer(void *arg)
+{
+  for (uint32_t idx = 0U; idx < THREAD_ITEMS; )
+  {
+    /* Every queue gets one item out of QUEUES, in order */
+    if (buff_push(&queues[idx % QUEUES], &idx) == EMBLIB32_OK)
+    {
+      idx++;
+      continue;
+    }
+    sched_yield();
+  }
+  return arg;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Select -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,348 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_telem.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Telemetry ring testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#include "emblib32_core.h"
+#include "emblib32_telem.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Telemetry
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define RING_SIZE         8U
+#define READERS           3U
+#define THREAD_ITEMS      100000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/** Test item: the sequence is repeated so torn reads can be detected */
+typedef struct
+{
+  uint32_t  seq[8];
+} t_test_item;
+
+/** Reader results */
+typedef struct
+{
+  uint32_t  received;           /*!< Items received */
+  bool      ordered;            /*!< Items arrived in order */
+  bool      consistent;         /*!< No torn item was received */
+  bool      accounted;          /*!< Every gap matched the lost count reported */
+} t_test_result;
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_telem         ctrl;
+size_t          slots[TELEM_STORAGE_SIZE(RING_SIZE, sizeof(t_test_item)) / sizeof(size_t)];
+t_telem_reader  readers[READERS];
+t_test_result   results[READERS];
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_telem_init(void);
+static void test_telem_read(void);
+static void test_telem_overrun(void);
+static void test_telem_threads(void);
+
+static void test_item_fill(t_test_item* item, uint32_t seq);
+static void *telem_writer(void *arg);
+static void *telem_reader(void *arg);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_telem_init);
+  RUN_TEST(test_telem_read);
+  RUN_TEST(test_telem_overrun);
+  RUN_TEST(test_telem_threads);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_telem_init(void)
+{
+  t_test_item item;
+
+  /* Sizes must be a power of two */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, telem_init(&ctrl, slots, 6U, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, telem_init(&ctrl, slots, 1U, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, telem_init(&ctrl, slots, RING_SIZE, 0U));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_init(&ctrl, slots, RING_SIZE, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_reader_init(&ctrl, &readers[0]));
+
+  /* Validate: nothing written yet */
+  TEST_ASSERT_EQUAL_UINT(0U, telem_get_count(&ctrl, &readers[0]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, telem_read(&ctrl, &readers[0], &item, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, telem_read(&ctrl, NULL, &item, NULL));
+}
+
+static void test_telem_read(void)
+{
+  t_test_item item;
+  uint32_t    lost;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_init(&ctrl, slots, RING_SIZE, sizeof(t_test_item)));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_reader_init(&ctrl, &readers[0]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_reader_init(&ctrl, &readers[1]));
+  for (uint32_t seq = 0U; seq < 3U; seq++)
+  {
+    test_item_fill(&item, seq);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_write(&ctrl, &item));
+  }
+
+  /* Run: readers are independent */
+  TEST_ASSERT_EQUAL_UINT(3U, telem_get_count(&ctrl, &readers[0]));
+  for (uint32_t seq = 0U; seq < 3U; seq++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_read(&ctrl, &readers[0], &item, &lost));
+    TEST_ASSERT_EQUAL_UINT32(seq, item.seq[0]);
+    TEST_ASSERT_EQUAL_UINT32(0U, lost);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, telem_read(&ctrl, &readers[0], &item, &lost));
+  TEST_ASSERT_EQUAL_UINT(3U, telem_get_count(&ctrl, &readers[1]));
+
+  /* Validate: sync drops the pending items, a late reader starts on the oldest item */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_sync(&ctrl, &readers[1]));
+  TEST_ASSERT_EQUAL_UINT(0U, telem_get_count(&ctrl, &readers[1]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_reader_init(&ctrl, &readers[2]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_read(&ctrl, &readers[2], &item, NULL));
+  TEST_ASSERT_EQUAL_UINT32(0U, item.seq[0]);
+  TEST_ASSERT_EQUAL_UINT32(0U, telem_get_lost(&readers[2]));
+}
+
+static void test_telem_overrun(void)
+{
+  t_test_item item;
+  uint32_t    lost;
+  uint32_t    total = (3U * RING_SIZE) + 3U;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_init(&ctrl, slots, RING_SIZE, sizeof(t_test_item)));
+  for (size_t reader = 0U; reader < READERS; reader++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_reader_init(&ctrl, &readers[reader]));
+  }
+
+  /* Run: the writer never waits */
+  for (uint32_t seq = 0U; seq < total; seq++)
+  {
+    test_item_fill(&item, seq);
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_write(&ctrl, &item));
+    if (seq == 2U)
+    {
+      TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_read(&ctrl, &readers[0], &item, NULL));
+      TEST_ASSERT_EQUAL_UINT32(0U, item.seq[0]);
+    }
+  }
+
+  /* Validate: lagging readers resume with the oldest item left and report what they lost */
+  TEST_ASSERT_EQUAL_UINT(RING_SIZE - 1U, telem_get_count(&ctrl, &readers[0]));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_read(&ctrl, &readers[0], &item, &lost));
+  TEST_ASSERT_EQUAL_UINT32(total - (RING_SIZE - 1U), item.seq[0]);
+  TEST_ASSERT_EQUAL_UINT32(total - RING_SIZE, lost);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_read(&ctrl, &readers[1], &item, &lost));
+  TEST_ASSERT_EQUAL_UINT32(total - (RING_SIZE - 1U), lost);
+  for (uint32_t seq = (total - (RING_SIZE - 2U)); seq < total; seq++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_read(&ctrl, &readers[1], &item, &lost));
+    TEST_ASSERT_EQUAL_UINT32(seq, item.seq[0]);
+    TEST_ASSERT_EQUAL_UINT32(0U, lost);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, telem_read(&ctrl, &readers[1], &item, &lost));
+  TEST_ASSERT_EQUAL_UINT32(total - RING_SIZE, telem_get_lost(&readers[0]));
+  TEST_ASSERT_EQUAL_UINT32(total - (RING_SIZE - 1U), telem_get_lost(&readers[1]));
+}
+
+static void test_telem_threads(void)
+{
+  pthread_t writer;
+  pthread_t threads[READERS];
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_init(&ctrl, slots, RING_SIZE, sizeof(t_test_item)));
+  memset(results, 0, sizeof(results));
+  for (size_t idx = 0U; idx < READERS; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, telem_reader_init(&ctrl, &readers[idx]));
+  }
+
+  /* Run */
+  for (uintptr_t idx = 0U; idx < READERS; idx++)
+  {
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&threads[idx], NULL, telem_reader, (void*)idx));
+  }
+  TEST_ASSERT_EQUAL_INT(0, pthread_create(&writer, NULL, telem_writer, NULL));
+  pthread_join(writer, NULL);
+  for (size_t idx = 0U; idx < READERS; idx++)
+  {
+    pthread_join(threads[idx], NULL);
+  }
+
+  /* Validate: every item was either received intact or reported as lost */
+  for (size_t idx = 0U; idx < READERS; idx++)
+  {
+    TEST_ASSERT_TRUE(results[idx].ordered);
+    TEST_ASSERT_TRUE(results[idx].consistent);
+    TEST_ASSERT_TRUE(results[idx].accounted);
+    TEST_ASSERT_EQUAL_UINT32(THREAD_ITEMS, results[idx].received + telem_get_lost(&readers[idx]));
+  }
+}
+
+static void test_item_fill(t_test_item* item, uint32_t seq)
+{
+  for (size_t idx = 0U; idx < ARRAY_SIZE(item->seq); idx++)
+  {
+    item->seq[idx] = seq;
+  }
+}
+
+static void *telem_writer(void *arg)
+{
+  t_test_item item;
+
+  UNUSED(arg);
+  for (uint32_t seq = 0U; seq < THREAD_ITEMS; seq++)
+  {
+    test_item_fill(&item, seq);
+    telem_write(&ctrl, &item);
+  }
+  return NULL;
+}
+
+static void *telem_reader(void *arg)
+{
+  size_t         reader  = (size_t)(uintptr_t)arg;
+  t_test_result* result  = &results[reader];
+  uint32_t       next    = 0U;
+  uint32_t       lost;
+  t_test_item    item;
+
+  result->ordered    = true;
+  result->consistent = true;
+  result->accounted  = true;
+  while (next < THREAD_ITEMS)
+  {
+    if (telem_read(&ctrl, &readers[reader], &item, &lost) != EMBLIB32_OK)
+    {
+      sched_yield();
+      continue;
+    }
+    for (size_t idx = 1U; idx < ARRAY_SIZE(item.seq); idx++)
+    {
+      if (item.seq[idx] != item.seq[0])
+      {
+        result->consistent = false;
+      }
+    }
+    if (item.seq[0] < next)
+    {
+      result->ordered = false;
+    }
+    else if ((item.seq[0] - next) != lost)
+    {
+      result->accounted = false;
+    }
+    next = item.seq[0] + 1U;
+    result->received++;
+  }
+  return NULL;
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Telemetry -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,259 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_tier.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Tiered buffer testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+
+#include "emblib32_core.h"
+#include "emblib32_buffer.h"
+#include "emblib32_tier.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Tier
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define RAM_SIZE          8U
+#define RAM_THRESHOLD     6U
+#define BATCH_SIZE        4U
+#define TEST_ITEMS        1000U
+#define TEST_PATH         "emblib32_test_tier.bin"
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#if TIER_SUPPORT == 1U
+t_tier    ctrl;
+t_buff    ram;
+uint32_t  ram_items[RAM_SIZE];
+uint32_t  batch[BATCH_SIZE];
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#if TIER_SUPPORT == 1U
+static void test_tier_init(void);
+static void test_tier_burst(void);
+static void test_tier_random(void);
+static void test_tier_compact(void);
+#endif
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+#if TIER_SUPPORT == 1U
+  RUN_TEST(test_tier_init);
+  RUN_TEST(test_tier_burst);
+  RUN_TEST(test_tier_random);
+  RUN_TEST(test_tier_compact);
+#endif
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#if TIER_SUPPORT == 1U
+static void test_tier_init(void)
+{
+  /* The RAM ring must be FIFO without overflow */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ram, ram_items, RAM_SIZE, sizeof(uint32_t), BUFF_OPMODE_DEFAULT, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, tier_init(&ctrl, &ram, RAM_THRESHOLD, batch, BATCH_SIZE, TEST_PATH));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ram, ram_items, RAM_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, tier_init(&ctrl, &ram, (RAM_SIZE + 1U), batch, BATCH_SIZE, TEST_PATH));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_init(&ctrl, &ram, RAM_THRESHOLD, batch, BATCH_SIZE, TEST_PATH));
+  TEST_ASSERT_EQUAL_UINT(0U, tier_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_deinit(&ctrl));
+}
+
+static void test_tier_burst(void)
+{
+  uint32_t item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ram, ram_items, RAM_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_init(&ctrl, &ram, RAM_THRESHOLD, batch, BATCH_SIZE, TEST_PATH));
+
+  /* Run: a burst much bigger than the RAM ring is absorbed */
+  for (item = 0U; item < TEST_ITEMS; item++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_push(&ctrl, &item));
+  }
+  TEST_ASSERT_EQUAL_UINT(TEST_ITEMS, tier_get_count(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(RAM_THRESHOLD, buff_get_count(&ram));
+  TEST_ASSERT_EQUAL_UINT(TEST_ITEMS - RAM_THRESHOLD, tier_get_spilled(&ctrl));
+
+  /* Validate: drained in order */
+  for (uint32_t expected = 0U; expected < TEST_ITEMS; expected++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_pop(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT32(expected, item);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, tier_pop(&ctrl, &item));
+  TEST_ASSERT_EQUAL_UINT(0U, tier_get_spilled(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_deinit(&ctrl));
+}
+
+static void test_tier_random(void)
+{
+  uint32_t pushed = 0U;
+  uint32_t popped = 0U;
+  uint32_t item;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ram, ram_items, RAM_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_init(&ctrl, &ram, RAM_THRESHOLD, batch, BATCH_SIZE, TEST_PATH));
+  srand(42U);
+
+  /* Run: bursts of pushes and pops, crossing between the tiers many times */
+  while (popped < (10U * TEST_ITEMS))
+  {
+    size_t burst = (size_t)(rand() % 24);
+    if ((rand() % 2) && (pushed < (10U * TEST_ITEMS)))
+    {
+      for (size_t idx = 0U; idx < burst; idx++, pushed++)
+      {
+        TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_push(&ctrl, &pushed));
+      }
+    }
+    else
+    {
+      for (size_t idx = 0U; (idx < burst) && (popped < pushed); idx++, popped++)
+      {
+        TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_pop(&ctrl, &item));
+        TEST_ASSERT_EQUAL_UINT32(popped, item);
+      }
+    }
+
+    /* Validate */
+    TEST_ASSERT_EQUAL_UINT(pushed - popped, tier_get_count(&ctrl));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_deinit(&ctrl));
+}
+
+static void test_tier_compact(void)
+{
+  uint32_t pushed = 0U;
+  uint32_t popped = 0U;
+  uint32_t item;
+
+  /* Prepare: keep a backlog on the file store */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&ram, ram_items, RAM_SIZE, sizeof(uint32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_init(&ctrl, &ram, RAM_THRESHOLD, batch, BATCH_SIZE, TEST_PATH));
+  for (; pushed < TEST_ITEMS; pushed++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_push(&ctrl, &pushed));
+  }
+
+  /* Run: the writer never lets the file store drain */
+  for (uint32_t idx = 0U; idx < (20U * TIER_COMPACT_THRESHOLD); idx++, pushed++, popped++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_push(&ctrl, &pushed));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_pop(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT32(popped, item);
+  }
+
+  /* Validate: the consumed prefix was dropped, the file store stays bounded */
+  TEST_ASSERT_GREATER_THAN_UINT(0U, ctrl.file_tail - ctrl.file_head);
+  TEST_ASSERT_LESS_THAN_UINT((2U * TIER_COMPACT_THRESHOLD) + TEST_ITEMS, ctrl.file_tail);
+  TEST_ASSERT_EQUAL_UINT(pushed - popped, tier_get_count(&ctrl));
+  for (; popped < pushed; popped++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_pop(&ctrl, &item));
+    TEST_ASSERT_EQUAL_UINT32(popped, item);
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, tier_deinit(&ctrl));
+}
+#endif /* TIER_SUPPORT */
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Tier -->
+*//*--------------------------------------------------------------------------*/
@@ -0,0 +1,253 @@
+/**
+ *******************************************************************************
+ * @file    test_emblib32_window.c
+ * @author  Christian Wiche
+ * @date    2024
+ * @brief   Sliding-window statistics testing
+ * @note    None
+ * @warning None
+ *******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2024 Christian Wiche. All rights reserved.
+ *
+ *******************************************************************************
+ */
+#include <stdlib.h>
+
+#include "emblib32_core.h"
+#include "emblib32_buffer.h"
+#include "emblib32_window.h"
+#include "unity.h"
+
+/*-------------------------------------------------------------------------*//**
+* @addtogroup EmbLib32
+* @{
+* @addtogroup Middlewares
+* @{
+* @addtogroup Window
+* @{
+* @defgroup PUBLIC_Definitions          PUBLIC constants
+* @defgroup PUBLIC_Macros               PUBLIC macros
+* @defgroup PUBLIC_Types                PUBLIC data-types
+* @defgroup PUBLIC_Data                 PUBLIC data / variables
+* @defgroup PUBLIC_API                  PUBLIC API
+* @defgroup PRIVATE_TUNABLES            PRIVATE compile-time tunables
+* @defgroup PRIVATE_Definitions         PRIVATE constants
+* @defgroup PRIVATE_Macros              PRIVATE macros
+* @defgroup PRIVATE_Types               PRIVATE data-types
+* @defgroup PRIVATE_Data                PRIVATE data / variables
+* @defgroup PRIVATE_Functions           PRIVATE functions
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_TUNABLES
+* @{
+*//*--------------------------------------------------------------------------*/
+
+#define WINDOW_SIZE       7U
+#define TEST_SAMPLES      2000U
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_TUNABLES -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Definitions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Definitions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Macros
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Macros -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Types
+* @{
+*//*--------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Types -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Data
+* @{
+*//*--------------------------------------------------------------------------*/
+
+t_window  ctrl;
+t_buff    samples;
+int32_t   items[WINDOW_SIZE];
+uint32_t  storage[WINDOW_STORAGE_SIZE(WINDOW_SIZE) / sizeof(uint32_t)];
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Data -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_window_init(void);
+static void test_window_basic(void);
+static void test_window_random(void);
+
+static void window_reference(t_window_stats* stats);
+static int compare_samples(const void* a, const void* b);
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PUBLIC_API
+* @{
+*//*--------------------------------------------------------------------------*/
+
+int main(void)
+{
+  UNITY_BEGIN();
+
+  RUN_TEST(test_window_init);
+  RUN_TEST(test_window_basic);
+  RUN_TEST(test_window_random);
+
+  UNITY_END();
+  return 0;
+}
+
+void setUp(void)
+{
+  /* Not required */
+}
+
+void tearDown(void)
+{
+  /* Not required */
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PUBLIC_API -->
+*//*-----------------------------------------------------------------------*//**
+* @addtogroup PRIVATE_Functions
+* @{
+*//*--------------------------------------------------------------------------*/
+
+static void test_window_init(void)
+{
+  t_window_stats stats;
+
+  /* Samples must be int32_t items read in FIFO order */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&samples, items, WINDOW_SIZE, sizeof(uint16_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, window_init(&ctrl, &samples, storage));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&samples, items, WINDOW_SIZE, sizeof(int32_t), BUFF_OPMODE_R_LIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, window_init(&ctrl, &samples, storage));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&samples, items, WINDOW_SIZE, sizeof(int32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_PARAMETER, window_init(&ctrl, &samples, NULL));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_init(&ctrl, &samples, storage));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_ERROR_BUFFER_EMPTY, window_get_stats(&ctrl, &stats));
+}
+
+static void test_window_basic(void)
+{
+  const int32_t  input[] = {4, -2, 9, 9, 1, -7, 3, 12, 0};
+  t_window_stats stats;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&samples, items, WINDOW_SIZE, sizeof(int32_t), BUFF_OPMODE_R_FIFO, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_init(&ctrl, &samples, storage));
+
+  /* Run: partial window {4, -2, 9, 9} */
+  for (size_t idx = 0U; idx < 4U; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_push(&ctrl, input[idx]));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_get_stats(&ctrl, &stats));
+  TEST_ASSERT_EQUAL_UINT(4U, stats.count);
+  TEST_ASSERT_EQUAL_INT64(20, stats.sum);
+  TEST_ASSERT_EQUAL_INT32(-2, stats.min);
+  TEST_ASSERT_EQUAL_INT32(9, stats.max);
+  TEST_ASSERT_EQUAL_INT32(5, stats.mean);
+  TEST_ASSERT_EQUAL_INT32(6, stats.median);
+  TEST_ASSERT_EQUAL_UINT64(20U, stats.variance);
+
+  /* Validate: full window {-2, 9, 9, 1, -7, 3, 12, 0} slid down to {9, 9, 1, -7, 3, 12, 0} */
+  for (size_t idx = 4U; idx < ARRAY_SIZE(input); idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_push(&ctrl, input[idx]));
+  }
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_get_stats(&ctrl, &stats));
+  TEST_ASSERT_EQUAL_UINT(WINDOW_SIZE, stats.count);
+  TEST_ASSERT_EQUAL_UINT(WINDOW_SIZE, buff_get_count(&samples));
+  TEST_ASSERT_EQUAL_INT64(27, stats.sum);
+  TEST_ASSERT_EQUAL_INT32(-7, stats.min);
+  TEST_ASSERT_EQUAL_INT32(12, stats.max);
+  TEST_ASSERT_EQUAL_INT32(3, stats.median);
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_clear(&ctrl));
+  TEST_ASSERT_EQUAL_UINT(0U, window_get_count(&ctrl));
+  TEST_ASSERT_TRUE(buff_is_empty(&samples));
+}
+
+static void test_window_random(void)
+{
+  t_window_stats stats;
+  t_window_stats expected;
+
+  /* Prepare */
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, buff_init(&samples, items, WINDOW_SIZE, sizeof(int32_t), BUFF_OPMODE_DEFAULT, true));
+  TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_init(&ctrl, &samples, storage));
+  srand(1234U);
+
+  /* Run: every update matches a full recomputation (small range, so duplicates are common) */
+  for (size_t idx = 0U; idx < TEST_SAMPLES; idx++)
+  {
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_push(&ctrl, ((rand() % 41) - 20)));
+    TEST_ASSERT_EQUAL_UINT(EMBLIB32_OK, window_get_stats(&ctrl, &stats));
+    window_reference(&expected);
+    TEST_ASSERT_EQUAL_UINT(expected.count, stats.count);
+    TEST_ASSERT_EQUAL_INT64(expected.sum, stats.sum);
+    TEST_ASSERT_EQUAL_UINT64(expected.sum_sq, stats.sum_sq);
+    TEST_ASSERT_EQUAL_INT32(expected.min, stats.min);
+    TEST_ASSERT_EQUAL_INT32(expected.max, stats.max);
+    TEST_ASSERT_EQUAL_INT32(expected.median, stats.median);
+  }
+}
+
+/**
+ * @brief Computes the min, max, median and sums by iterating the samples buffer
+ * @param stats Reference statistics
+ */
+static void window_reference(t_window_stats* stats)
+{
+  int32_t sorted[WINDOW_SIZE];
+  size_t  count = buff_get_count(&samples);
+
+  stats->count  = count;
+  stats->sum    = 0;
+  stats->sum_sq = 0U;
+  for (size_t idx = 0U; idx < count; idx++)
+  {
+    buff_peek(&samples, &sorted[idx], idx);
+    stats->sum    += sorted[idx];
+    stats->sum_sq += (uint64_t)((int64_t)sorted[idx] * sorted[idx]);
+  }
+  qsort(sorted, count, sizeof(int32_t), compare_samples);
+  stats->min    = sorted[0];
+  stats->max    = sorted[count - 1U];
+  stats->median = sorted[(count - 1U) / 2U];
+  if ((count % 2U) == 0U)
+  {
+    stats->median = (int32_t)(((int64_t)sorted[(count / 2U) - 1U] + sorted[count / 2U]) / 2);
+  }
+}
+
+static int compare_samples(const void* a, const void* b)
+{
+  int32_t lhs = *(const int32_t*)a;
+  int32_t rhs = *(const int32_t*)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+/*-------------------------------------------------------------------------*//**
+* @} <!-- End: PRIVATE_Functions -->
+*//*-----------------------------------------------------------------------*//**
+* @} <!-- End: EmbLib32 -->
+* @} <!-- End: Middlewares -->
+* @} <!-- End: Window -->
+*//*--------------------------------------------------------------------------*/